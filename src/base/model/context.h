@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <tuple>
+#include <utility>
+
+namespace eda::base::model {
+
+/**
+ * \brief Owns the node storages (nodes and structural hashing tables) of
+ *        a single design.
+ *
+ * A context is activated for the current thread by creating a scope:
+ *
+ *   DesignContext<GateBase, VNodeBase> context;
+ *   {
+ *     DesignContext<GateBase, VNodeBase>::Scope scope(context);
+ *     // Nodes are created in (and resolved through) the context.
+ *   }
+ *
+ * Independent designs may be processed in different threads, each thread
+ * w/ its own context. Destroying a context releases all its nodes.
+ */
+template <typename... Nodes>
+class DesignContext final {
+public:
+  /// Activates the context for the current thread (RAII).
+  class Scope final {
+  public:
+    explicit Scope(DesignContext &context):
+        _previous(context.activate(std::index_sequence_for<Nodes...>{})) {}
+
+    ~Scope() {
+      restore(_previous, std::index_sequence_for<Nodes...>{});
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator =(const Scope &) = delete;
+
+  private:
+    using Previous = std::tuple<typename Nodes::Storage*...>;
+
+    template <std::size_t... I>
+    static void restore(const Previous &previous, std::index_sequence<I...>) {
+      (Nodes::setStorage(std::get<I>(previous)), ...);
+    }
+
+    const Previous _previous;
+  };
+
+  DesignContext() = default;
+  DesignContext(const DesignContext &) = delete;
+  DesignContext &operator =(const DesignContext &) = delete;
+
+  /// Returns the storage of the given node type.
+  template <typename N>
+  typename N::Storage &storage() {
+    return std::get<typename N::Storage>(_storages);
+  }
+
+private:
+  template <std::size_t... I>
+  std::tuple<typename Nodes::Storage*...> activate(std::index_sequence<I...>) {
+    return std::make_tuple(Nodes::setStorage(&std::get<I>(_storages))...);
+  }
+
+  std::tuple<typename Nodes::Storage...> _storages;
+};
+
+} // namespace eda::base::model
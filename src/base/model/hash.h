@@ -11,88 +11,271 @@
 #include "base/model/signal.h"
 
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 namespace eda::base::model {
 
 /**
- * \brief Represents an inexact (loosy) key for hashing net nodes.
- * \author <a href="mailto:kamkin@ispras.ru">Alexander Kamkin</a>
+ * \brief Implements an exact structural hashing table for net nodes.
+ *
+ * The table maps a node signature (net, function, inputs w/ events) to
+ * the node identifier. Inputs of commutative functions are compared as
+ * multisets. It is an open-addressing table w/ linear probing: signatures
+ * of arity up to INLINE_ARITY are stored inline (in the canonical order);
+ * longer ones are compared against the inputs of the stored node, which
+ * are provided by the resolver passed to the lookup functions. Lookups
+ * do not allocate memory.
+ *
+ * The net identifier is a part of the signature: a node is never found in
+ * a net other than the one it has been inserted into. It is not hashed,
+ * though: the entries of a node (it may be inserted into several nets)
+ * share the probe sequence, so they are removed w/o knowing the nets.
+ *
+ * A node must be erased from the table before its function or inputs are
+ * changed (otherwise, the table becomes inconsistent).
  */
 template <typename F, typename N>
-struct NodeHashKey final {
+class StructHashTable final {
+public:
   using Signal = eda::base::model::Signal<N>;
   using SignalList = typename Signal::List;
 
-  /// Constructs a key from the given node signature.
-  NodeHashKey(uint32_t netId, F func, const SignalList &inputs):
-      netId(netId),
-      func(static_cast<uint16_t>(func)),
-      arity(static_cast<uint16_t>(inputs.size())) {
+  /// Maximum arity of the signatures stored inline.
+  static constexpr size_t INLINE_ARITY = 4;
 
-    std::vector<size_t> hashes(inputs.size());
-    for (size_t i = 0; i < inputs.size(); i++) {
-      hashes[i] = std::hash<N>()(inputs[i].node());
+  /// Node identifier returned if nothing is found.
+  static constexpr N NONE = static_cast<N>(-1);
+
+  StructHashTable(): _size(0), _used(0) {}
+
+  /// Returns the number of signatures.
+  size_t size() const { return _size; }
+
+  /// Returns the node w/ the given signature or NONE.
+  template <typename Resolver>
+  N find(uint32_t netId, F func, const SignalList &inputs,
+         const Resolver &resolve) const {
+    if (_entries.empty()) {
+      return NONE;
+    }
+
+    Key key(netId, func, inputs.data(), inputs.size());
+    const auto hash = key.hash();
+
+    for (size_t i = hash & mask();; i = (i + 1) & mask()) {
+      const auto &entry = _entries[i];
+
+      if (entry.node == EMPTY) {
+        return NONE;
+      }
+      if (entry.node != DELETED && match(entry, hash, key, resolve)) {
+        return entry.node;
+      }
     }
+  }
+
+  /// Adds the node w/ the given signature (does nothing if it is present).
+  template <typename Inputs>
+  void insert(uint32_t netId, F func, const Inputs &inputs, N node) {
+    assert(node != EMPTY && node != DELETED);
 
-    if (func.isCommutative()) {
-      std::sort(hashes.begin(), hashes.end());
+    if (2 * (_used + 1) > _entries.size()) {
+      rehash(2 * (_size + 1) > _entries.size() / 2 ? 2 * _entries.size()
+                                                   : _entries.size());
     }
 
-    const uint64_t prime = 37;
+    Key key(netId, func, inputs.data(), inputs.size());
+    const auto hash = key.hash();
+
+    size_t free = _entries.size();
+    size_t i = hash & mask();
+
+    for (;; i = (i + 1) & mask()) {
+      const auto &entry = _entries[i];
 
-    ihash = 0;
-    for (const auto hash : hashes) {
-      ihash *= prime;
-      ihash += hash;
+      if (entry.node == EMPTY) {
+        break;
+      }
+      if (entry.node == DELETED) {
+        free = std::min(free, i);
+      } else if (entry.node == node && entry.netId == netId) {
+        return;
+      }
     }
+
+    if (free == _entries.size()) {
+      free = i;
+      _used++;
+    }
+
+    auto &entry = _entries[free];
+    entry.hash  = hash;
+    entry.node  = node;
+    entry.netId = key.netId;
+    entry.func  = static_cast<uint16_t>(func);
+    entry.arity = static_cast<uint32_t>(key.arity);
+    std::copy(key.inputs, key.inputs + key.inlined(), entry.inputs);
+
+    _size++;
   }
 
-  /// Compares this key w/ the given one.
-  constexpr bool operator ==(const NodeHashKey &rhs) const {
-    return netId == rhs.netId
-        && func  == rhs.func
-        && arity == rhs.arity
-        && ihash == rhs.ihash;
+  /// Removes the entries of the node w/ the given signature in all nets.
+  template <typename Inputs>
+  void erase(F func, const Inputs &inputs, N node) {
+    if (_entries.empty()) {
+      return;
+    }
+
+    // The net identifier is not hashed (any net fits).
+    Key key(0, func, inputs.data(), inputs.size());
+    const auto hash = key.hash();
+
+    for (size_t i = hash & mask();; i = (i + 1) & mask()) {
+      auto &entry = _entries[i];
+
+      if (entry.node == EMPTY) {
+        return;
+      }
+      if (entry.node == node) {
+        entry.node = DELETED;
+        _size--;
+      }
+    }
   }
 
-  /// Network identifier (exact).
-  uint32_t netId;
-  /// Functional symbol (exact).
-  uint16_t func;
-  /// Node arity (exact).
-  uint16_t arity;
-  /// Hash code(s) of node inputs.
-  uint64_t ihash;
-};
+private:
+  static constexpr N EMPTY   = static_cast<N>(-1);
+  static constexpr N DELETED = static_cast<N>(-2);
 
-} // namespace eda::base::model
+  /// Initial number of buckets.
+  static constexpr size_t MIN_CAPACITY = 1024;
 
-//===----------------------------------------------------------------------===//
-// Hash
-//===----------------------------------------------------------------------===//
+  struct Entry final {
+    uint64_t hash;
+    N node = EMPTY;
+    uint32_t netId;
+    uint16_t func;
+    uint32_t arity;
+    Signal inputs[INLINE_ARITY];
+  };
 
-namespace std {
+  /// Signature being looked up (not stored).
+  struct Key final {
+    Key(uint32_t netId, F func, const Signal *all, size_t arity):
+        netId(netId),
+        func(func),
+        commutative(func.isCommutative()),
+        arity(arity),
+        all(all) {
+      std::copy(all, all + inlined(), inputs);
+      if (commutative) {
+        std::sort(inputs, inputs + inlined(), less);
+      }
+    }
 
-/**
- * \brief Implements hash code computation for NodeHashKey.
- * \author <a href="mailto:kamkin@ispras.ru">Alexander Kamkin</a>
- */
-template <typename F, typename N>
-struct hash<eda::base::model::NodeHashKey<F, N>> {
-  size_t operator()(const eda::base::model::NodeHashKey<F, N> &key) const {
-    const size_t prime = 37;
-
-    size_t hash = key.netId;
-    hash *= prime;
-    hash += key.func;
-    hash *= prime;
-    hash += key.arity;
-    hash *= prime;
-    hash += key.ihash;
-
-    return hash;
+    size_t inlined() const {
+      return arity <= INLINE_ARITY ? arity : 0;
+    }
+
+    /// Returns the hash of the function and the inputs (w/o the net).
+    uint64_t hash() const {
+      uint64_t h = 0;
+      for (const auto *input = all; input != all + arity; input++) {
+        const auto x = mix((static_cast<uint64_t>(input->node()) << 8)
+                         | static_cast<uint64_t>(input->event()));
+        // Order-independent combination for commutative functions.
+        h = commutative ? h + x : mix(h ^ x);
+      }
+
+      const uint64_t code = static_cast<uint16_t>(func);
+      return mix(h ^ (code << 32) ^ arity);
+    }
+
+    const uint32_t netId;
+    const F func;
+    const bool commutative;
+    const size_t arity;
+    const Signal *all;
+    Signal inputs[INLINE_ARITY];
+  };
+
+  static uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+  }
+
+  static bool less(const Signal &lhs, const Signal &rhs) {
+    return lhs.node() != rhs.node() ? lhs.node() < rhs.node()
+                                    : lhs.event() < rhs.event();
+  }
+
+  template <typename Resolver>
+  static bool match(const Entry &entry, uint64_t hash, const Key &key,
+                    const Resolver &resolve) {
+    if (entry.hash != hash || entry.netId != key.netId
+                           || entry.func != static_cast<uint16_t>(key.func)
+                           || entry.arity != key.arity) {
+      return false;
+    }
+
+    if (key.arity <= INLINE_ARITY) {
+      return std::equal(key.inputs, key.inputs + key.arity, entry.inputs);
+    }
+
+    const auto &inputs = resolve(entry.node);
+    if (!key.commutative) {
+      return std::equal(key.all, key.all + key.arity, inputs.begin());
+    }
+
+    // The buffers are reused to avoid allocations.
+    thread_local SignalList lhs, rhs;
+    lhs.assign(key.all, key.all + key.arity);
+    rhs.assign(inputs.begin(), inputs.end());
+    std::sort(lhs.begin(), lhs.end(), less);
+    std::sort(rhs.begin(), rhs.end(), less);
+
+    return lhs == rhs;
+  }
+
+  size_t mask() const {
+    return _entries.size() - 1;
+  }
+
+  void rehash(size_t capacity) {
+    capacity = std::max(capacity, MIN_CAPACITY);
+    assert((capacity & (capacity - 1)) == 0);
+
+    std::vector<Entry> entries(capacity);
+    std::swap(_entries, entries);
+
+    for (const auto &entry : entries) {
+      if (entry.node == EMPTY || entry.node == DELETED) {
+        continue;
+      }
+
+      size_t i = entry.hash & mask();
+      while (_entries[i].node != EMPTY) {
+        i = (i + 1) & mask();
+      }
+      _entries[i] = entry;
+    }
+
+    _used = _size;
   }
+
+  /// Buckets (the number is a power of two).
+  std::vector<Entry> _entries;
+  /// Number of the stored signatures.
+  size_t _size;
+  /// Number of the occupied buckets (including the deleted ones).
+  size_t _used;
 };
 
-} // namespace std
+} // namespace eda::base::model
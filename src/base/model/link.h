@@ -10,6 +10,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace eda::base::model {
@@ -28,7 +29,7 @@ struct Link final {
 
   // General link.
   Link(N source, N target, std::size_t input):
-    source(source), target(target), input(input) {}
+    source(source), target(target), input(static_cast<uint32_t>(input)) {}
 
   // Self-link (a port).
   explicit Link(N node): Link(node, node, 0) {}
@@ -52,7 +53,7 @@ struct Link final {
   /// Target node.
   N target;
   /// Target input index.
-  size_t input;
+  uint32_t input;
 };
 
 } // namespace eda::base::model
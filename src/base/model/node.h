@@ -11,15 +11,23 @@
 #include "base/model/hash.h"
 #include "base/model/link.h"
 #include "base/model/signal.h"
+#include "util/arena.h"
+#include "util/small_vector.h"
 
 #include <algorithm>
 #include <cassert>
-#include <unordered_map>
-#include <unordered_set>
+#include <cstddef>
+#include <iterator>
+#include <memory>
 #include <vector>
 
 namespace eda::base::model {
 
+/// Concrete node type for the given function type (specialized by the
+/// models); the nodes are destroyed as the objects of this type.
+template <typename Func>
+struct NodeType;
+
 /**
  * \brief Represents a net node (a gate or a higher-level unit).
  * \author <a href="mailto:kamkin@ispras.ru">Alexander Kamkin</a>
@@ -40,17 +48,185 @@ public:
   using LinkList = Link::List;
   using Signal = eda::base::model::Signal<Id>;
   using SignalList = Signal::List;
-  using StructHashKey = NodeHashKey<Func, Id>;
-  using StructHashMap = std::unordered_map<StructHashKey, Id>;
+
+  /// Number of links stored inline (in the gate-level nets, the fanout of
+  /// about 98% of the gates does not exceed 2).
+  static constexpr size_t INLINE_LINKS = 2;
+
+  /**
+   * \brief Represents the node inputs as a range of signals.
+   *
+   * The range is invalidated by the changes of the inputs.
+   */
+  class InputList final {
+  public:
+    using value_type = Signal;
+    using const_iterator = const Signal*;
+    using iterator = const_iterator;
+
+    InputList(const Signal *begin, const Signal *end):
+        _begin(begin), _end(end) {}
+
+    const_iterator begin()  const { return _begin; }
+    const_iterator end()    const { return _end; }
+    const_iterator cbegin() const { return _begin; }
+    const_iterator cend()   const { return _end; }
+
+    const Signal *data() const { return _begin; }
+    size_t size() const { return _end - _begin; }
+    bool empty() const { return _begin == _end; }
+
+    const Signal &operator[](size_t i) const { return _begin[i]; }
+
+  private:
+    const Signal *_begin;
+    const Signal *_end;
+  };
+
+  /// Fanout entry: a link w/o the source (the source is the node itself).
+  struct Fanout final {
+    /// Target node.
+    Id target;
+    /// Target input index.
+    uint32_t input;
+  };
+
+  /**
+   * \brief Represents the node fanout as a range of links.
+   *
+   * The links are constructed on the fly from the fanout entries; the
+   * range is invalidated by the changes of the fanout.
+   */
+  class FanoutList final {
+  public:
+    class const_iterator final {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = Link;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = Link;
+
+      const_iterator(Id source, const Fanout *entry):
+          _source(source), _entry(entry) {}
+
+      Link operator *() const {
+        return Link(_source, _entry->target, _entry->input);
+      }
+
+      const_iterator &operator ++() {
+        _entry++;
+        return *this;
+      }
+
+      const_iterator operator ++(int) {
+        auto copy = *this;
+        _entry++;
+        return copy;
+      }
+
+      bool operator ==(const const_iterator &rhs) const {
+        return _entry == rhs._entry;
+      }
+
+      bool operator !=(const const_iterator &rhs) const {
+        return _entry != rhs._entry;
+      }
+
+    private:
+      Id _source;
+      const Fanout *_entry;
+    };
+
+    using value_type = Link;
+    using iterator = const_iterator;
+
+    FanoutList(Id source, const Fanout *begin, const Fanout *end):
+        _source(source), _begin(begin), _end(end) {}
+
+    const_iterator begin()  const { return const_iterator(_source, _begin); }
+    const_iterator end()    const { return const_iterator(_source, _end); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend()   const { return end(); }
+
+    size_t size() const { return _end - _begin; }
+    bool empty() const { return _begin == _end; }
+
+    Link operator[](size_t i) const {
+      return Link(_source, _begin[i].target, _begin[i].input);
+    }
+
+  private:
+    Id _source;
+    const Fanout *_begin;
+    const Fanout *_end;
+  };
+  using StructHashTable = eda::base::model::StructHashTable<Func, Id>;
+
+  //===--------------------------------------------------------------------===//
+  // Storage
+  //===--------------------------------------------------------------------===//
+
+  /**
+   * \brief Owns the nodes of a design and the structural hashing table.
+   *
+   * Node identifiers are local to the storage. The storage that is used for
+   * creating and resolving nodes is set per thread (see setStorage()); by
+   * default, all threads share the process-wide storage. The nodes are
+   * allocated in the storage's arena and released all at once.
+   */
+  class Storage final {
+    friend class Node<Func, StructHash>;
+
+  public:
+    Storage() = default;
+    Storage(const Storage &) = delete;
+    Storage &operator =(const Storage &) = delete;
+
+    /// Destroys the storage and all the nodes it contains.
+    ~Storage() {
+      using Type = typename NodeType<Func>::Type;
+      for (auto *node : _nodes) {
+        static_cast<Type*>(node)->~Type();
+      }
+    }
+
+    /// Returns the number of nodes.
+    size_t size() const { return _nodes.size(); }
+
+    /// Returns the number of bytes occupied by the nodes.
+    size_t bytesUsed() const { return _arena.used(); }
+    /// Returns the number of bytes reserved for the nodes.
+    size_t bytesReserved() const { return _arena.reserved(); }
+
+  private:
+    /// Memory for the nodes.
+    eda::utils::Arena _arena;
+    /// Nodes indexed by identifiers.
+    List _nodes;
+    /// Structural hashing.
+    StructHashTable _hashing;
+  };
+
+  /// Returns the storage used by the current thread.
+  static Storage &storage() { return *_storage; }
+
+  /// Sets the storage for the current thread and returns the previous one.
+  static Storage *setStorage(Storage *storage) {
+    assert(storage != nullptr);
+    auto *previous = _storage;
+    _storage = storage;
+    return previous;
+  }
 
   //===--------------------------------------------------------------------===//
   // Accessor
   //===--------------------------------------------------------------------===//
 
   /// Returns the node w/ the given id from the storage.
-  static Node<Func, StructHash> *get(Id id) { return _storage[id]; }
+  static Node<Func, StructHash> *get(Id id) { return _storage->_nodes[id]; }
   /// Returns the next node identifier.
-  static Id nextId() { return _storage.size(); }
+  static Id nextId() { return _storage->_nodes.size(); }
 
   /// Returns the node w/ the given function/inputs from the storage.
   static Node<Func, StructHash> *get(
@@ -66,31 +242,22 @@ public:
   Id id() const { return _id; }
   Func func() const { return _func; }
 
-  bool hasSignature(Func func, const SignalList &inputs) {
-    if (func != _func || inputs.size() != _inputs.size()) {
-      return false;
-    }
-
-    std::unordered_set<Id> inputSet;
-    for (size_t i = 0; i < inputs.size(); i++) {
-      inputSet.insert(inputs[i].node());
-      inputSet.insert(_inputs[i].node());
-    }
-
-    return inputSet.size() == inputs.size();
-  }
-
   //===--------------------------------------------------------------------===//
   // Connections
   //===--------------------------------------------------------------------===//
 
-  size_t arity() const { return _inputs.size(); }
-  const SignalList &inputs() const { return _inputs; }
-  const Signal &input(size_t i) const { return _inputs[i]; }
+  size_t arity() const { return _arity; }
+  InputList inputs() const { return InputList(_inputs, _inputs + _arity); }
+  const Signal &input(size_t i) const {
+    assert(i < _arity);
+    return _inputs[i];
+  }
 
   size_t fanout() const { return _links.size(); }
-  const LinkList &links() const { return _links; }
-  const Link &link(size_t i) const { return _links[i]; }
+  FanoutList links() const {
+    return FanoutList(_id, _links.begin(), _links.end());
+  }
+  Link link(size_t i) const { return links()[i]; }
 
   //===--------------------------------------------------------------------===//
   // Signal Wrappers
@@ -106,68 +273,132 @@ protected:
   /// Creates a node w/ the given function/inputs and
   /// allocates this node in the storage.
   Node(Func func, const SignalList &inputs):
-    _id(_storage.size()), _func(func), _inputs(inputs) {
+    _id(nextId()), _func(func), _arity(0), _capacity(0), _inputs(nullptr) {
     // Register the node in the storage.
-    if (_id >= _storage.size()) {
-      _storage.resize(_id + 1);
-      _storage[_id] = this;
-    }
+    _storage->_nodes.push_back(this);
+    assignInputs(inputs);
     appendLinks();
   }
 
   /// Creates a node w/ the given function/inputs and
   /// stores this node in the existing position.
   Node(Id id, Func func, const SignalList &inputs):
-    _id(id), _func(func), _inputs(inputs) {
-    assert(_id < _storage.size());
-    _storage[_id] = this;
+    _id(id), _func(func), _arity(0), _capacity(0), _inputs(nullptr) {
+    assert(_id < _storage->_nodes.size());
+    _storage->_nodes[_id] = this;
+    assignInputs(inputs);
     appendLinks();
   }
 
+  /// Nodes are destroyed together w/ their storage (see NodeType).
+  ~Node() = default;
+
+  /// Allocates a node in the arena of the current storage.
+  static void *operator new(size_t size) {
+    return _storage->_arena.allocate(size, alignof(Node<Func, StructHash>));
+  }
+
+  /// Places a node at the given address (see the in-place replacement).
+  static void *operator new(size_t, void *place) {
+    return place;
+  }
+
+  /// Does nothing: the memory is released together w/ the storage.
+  static void operator delete(void *) {}
+  static void operator delete(void *, void *) {}
+
   void setFunc(Func func) {
+    if (func != _func) {
+      unhash();
+    }
     _func = func;
   }
 
   void setInputs(const SignalList &inputs) {
+    unhash();
     removeLinks();
-    _inputs.assign(inputs.begin(), inputs.end());
+    assignInputs(inputs);
     appendLinks();
   }
 
-  void appendLink(Id to, size_t i) {
-    Link link(_id, to, i);
-    _links.push_back(link);
+  /// Copies the inputs to the array allocated in the storage arena (the
+  /// array is reused if it is large enough).
+  void assignInputs(const SignalList &inputs) {
+    const auto arity = static_cast<uint32_t>(inputs.size());
+
+    if (arity > _capacity) {
+      // The inputs are followed by the slots.
+      const auto size = arity * (sizeof(Signal) + sizeof(uint32_t));
+      _inputs = static_cast<Signal*>(
+          _storage->_arena.allocate(size, alignof(Signal)));
+      _capacity = arity;
+    }
+
+    std::uninitialized_copy(inputs.begin(), inputs.end(), _inputs);
+    _arity = arity;
   }
 
-  void removeLink(Id to, size_t input) {
-    Link link(_id, to, input);
-    auto i = std::remove(_links.begin(), _links.end(), link);
-    _links.erase(i, _links.end());
+  /// Returns the positions of the input links in the drivers' fanouts.
+  uint32_t *slots() {
+    return reinterpret_cast<uint32_t*>(_inputs + _capacity);
+  }
+
+  /// Appends the link and returns its position in the fanout.
+  uint32_t appendLink(Id to, size_t i) {
+    _links.push_back(Fanout{to, static_cast<uint32_t>(i)});
+    return _links.size() - 1;
+  }
+
+  /// Removes the link at the given position (the last link takes its place).
+  void removeLink(uint32_t slot) {
+    assert(slot < _links.size());
+
+    const auto &last = _links.back();
+    if (slot != _links.size() - 1) {
+      // Update the back-reference of the moved link.
+      get(last.target)->slots()[last.input] = slot;
+      _links[slot] = last;
+    }
+
+    _links.pop_back();
   }
 
   void appendLinks() {
-    for (size_t i = 0; i < _inputs.size(); i++) {
+    for (size_t i = 0; i < _arity; i++) {
       auto *node = Node<Func, StructHash>::get(_inputs[i].node());
-      node->appendLink(_id, i);
+      slots()[i] = node->appendLink(_id, i);
+    }
+  }
+
+  /// Removes the node from the structural hashing table.
+  void unhash() {
+    if constexpr(StructHash) {
+      _storage->_hashing.erase(_func, inputs(), _id);
     }
   }
 
   void removeLinks() {
-    for (size_t i = 0; i < _inputs.size(); i++) {
+    for (size_t i = 0; i < _arity; i++) {
       auto *node = Node<Func, StructHash>::get(_inputs[i].node());
-      node->removeLink(_id, i);
+      assert(node->link(slots()[i]) == Link(node->_id, _id, i));
+      node->removeLink(slots()[i]);
     }
   }
 
   const Id _id;
   Func _func;
-  SignalList _inputs;
-  LinkList _links;
-
-  /// Node storage.
-  static List _storage;
-  /// Structural hashing.
-  static StructHashMap _hashing;
+  /// Number of inputs and the capacity of the input array.
+  uint32_t _arity;
+  uint32_t _capacity;
+  /// Inputs followed by the positions of the input links in the drivers'
+  /// fanouts (the array is allocated in the storage arena).
+  Signal *_inputs;
+  eda::utils::SmallVector<Fanout, INLINE_LINKS> _links;
+
+  /// Process-wide storage (used by default).
+  static Storage _default;
+  /// Storage of the current thread.
+  static thread_local Storage *_storage;
 };
 
 template <typename Func, bool StructHash>
@@ -190,18 +421,10 @@ Node<Func, StructHash> *Node<Func, StructHash>::get(
   }
 
   // Search for the same node.
-  StructHashKey key(netId, func, inputs);
-  auto i = _hashing.find(key);
-
-  // If the same node exists, return it.
-  if (i != _hashing.end()) {
-    auto *node = get(i->second);
-    if (node->hasSignature(func, inputs)) {
-      return node;
-    }
-  }
+  const auto id = _storage->_hashing.find(netId, func, inputs,
+      [](Id id) { return get(id)->inputs(); });
 
-  return nullptr;
+  return id != StructHashTable::NONE ? get(id) : nullptr;
 }
 
 template <typename Func, bool StructHash>
@@ -211,22 +434,19 @@ void Node<Func, StructHash>::add(uint32_t netId, Node<Func, StructHash> *node) {
     return;
   }
 
-  StructHashKey key(netId, node->func(), node->inputs());
-  _hashing.insert({key, node->id()});
+  // Source nodes are never looked up.
+  if (!node->func().isConstant() && node->inputs().empty()) {
+    return;
+  }
+
+  _storage->_hashing.insert(netId, node->func(), node->inputs(), node->id());
 }
 
 template <typename Func, bool StructHash>
-typename Node<Func, StructHash>::List Node<Func, StructHash>::_storage = []{
-  Node<Func, StructHash>::List storage;
-  storage.reserve(1024*1024);
-  return storage;
-}();
+typename Node<Func, StructHash>::Storage Node<Func, StructHash>::_default;
 
 template <typename Func, bool StructHash>
-typename Node<Func, StructHash>::StructHashMap Node<Func, StructHash>::_hashing = []{
-  Node<Func, StructHash>::StructHashMap hashing;
-  hashing.reserve(1024*1024);
-  return hashing;
-}();
+thread_local typename Node<Func, StructHash>::Storage
+    *Node<Func, StructHash>::_storage = &Node<Func, StructHash>::_default;
 
 } // namespace eda::base::model
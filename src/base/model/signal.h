@@ -8,7 +8,9 @@
 
 #pragma once
 
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 
@@ -41,6 +43,10 @@ enum Event {
 
 /**
  * \brief Represents an event-triggered signal.
+ *
+ * The signal is packed: the node field holds the delay value for the
+ * explicit delay signals (such signals do not refer to nodes).
+ *
  * \author <a href="mailto:kamkin@ispras.ru">Alexander Kamkin</a>
  */
 template <typename N>
@@ -56,10 +62,12 @@ public:
   static Signal<N> delay(size_t delay) { return Signal(delay); }
 
   Signal(Event event, N node):
-    _event(event), _node(node), _delay(0) {}
+    _node(node), _event(event) {}
 
-  Signal(size_t delay):
-    _event(DELAY), _node(), _delay(delay) {}
+  explicit Signal(size_t delay):
+    _node(static_cast<N>(delay)), _event(DELAY) {
+    assert(static_cast<size_t>(_node) == delay);
+  }
 
   Signal():
     _event(ALWAYS) {}
@@ -80,27 +88,20 @@ public:
     return _event == DELAY;
   }
 
-  Event event()  const { return _event; }
-  const N node() const { return _node;  }
-  size_t delay() const { return _delay; }
+  Event event()  const { return static_cast<Event>(_event); }
+  const N node() const { return isDelay() ? N() : _node; }
+  size_t delay() const { return isDelay() ? static_cast<size_t>(_node) : 0; }
 
   bool operator ==(const Signal<N> &rhs) const {
-    if (&rhs == this) {
-      return true;
-    }
-
     return _event == rhs._event
-        && _node  == rhs._node
-        && _delay == rhs._delay;
+        && _node  == rhs._node;
   }
 
 private:
-  // Event kind.
-  Event _event;
-  // Node for tracking events on.
+  // Node for tracking events on (or delay value).
   N _node;
-  // Delay value.
-  size_t _delay;
+  // Event kind.
+  uint8_t _event;
 };
 
 inline std::ostream &operator <<(std::ostream &out, Event event) {
@@ -9,8 +9,12 @@
 #include "gate/debugger/checker.h"
 #include "gate/debugger/encoder.h"
 #include "gate/simulator/simulator.h"
+#include "util/id_map.h"
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
+#include <vector>
 
 namespace eda::gate::debugger {
 
@@ -233,23 +237,71 @@ bool Checker::areEqualCombSim(const GNet &lhs,
 
   eda::gate::simulator::Simulator simulator;
 
-  auto lhsCompiled = simulator.compile(lhs, lhsInputs, lhsOutputs);
-  auto rhsCompiled = simulator.compile(rhs, rhsInputs, rhsOutputs);
+  using Compiled = eda::gate::simulator::Simulator::Compiled;
 
-  for (std::uint64_t in = 0; in < (1ull << lhs.nSourceLinks()); in++) {
-    std::uint64_t lhsOut, rhsOut;
+  // Each pass evaluates nWords * WIDTH patterns (the vector kernels are
+  // used if there are enough patterns).
+  const std::uint64_t nPatterns = 1ull << lhs.nSourceLinks();
+  const std::size_t nNative = Compiled::nativeWords();
+  const std::size_t nWords =
+      (nPatterns >= nNative * Compiled::WIDTH) ? nNative : 1;
+
+  auto lhsCompiled = simulator.compile(lhs, lhsInputs, lhsOutputs, nWords);
+  auto rhsCompiled = simulator.compile(rhs, rhsInputs, rhsOutputs, nWords);
+
+  Compiled::WV in(lhsInputs.size() * nWords);
+  Compiled::WV lhsOut(lhsOutputs.size() * nWords);
+  Compiled::WV rhsOut(rhsOutputs.size() * nWords);
+
+  for (std::uint64_t base = 0; base < nPatterns;
+       base += nWords * Compiled::WIDTH) {
+    Compiled::getPatterns(in, base, nWords);
 
     lhsCompiled.simulate(lhsOut, in);
     rhsCompiled.simulate(rhsOut, in);
 
-    if (lhsOut != rhsOut) {
-      return false;
+    for (std::size_t j = 0; j < nWords; j++) {
+      // Only the first nPatterns patterns are valid.
+      const auto word = base + j * Compiled::WIDTH;
+      const auto mask = (word >= nPatterns) ? Compiled::W{0}
+          : (nPatterns - word >= Compiled::WIDTH) ? ~Compiled::W{0}
+          : (Compiled::W{1} << (nPatterns - word)) - 1;
+
+      for (std::size_t i = 0; i < lhsOutputs.size(); i++) {
+        if ((lhsOut[i * nWords + j] ^ rhsOut[i * nWords + j]) & mask) {
+          return false;
+        }
+      }
     }
   }
 
   return true;
 }
 
+bool Checker::areEqualOutputs(const GNet &lhs,
+                              const GNet &rhs,
+                              const Hints &hints,
+                              Verdicts &verdicts,
+                              std::size_t nGroups,
+                              bool stop,
+                              ThreadPool &pool) const {
+  assert(hints.isKnownIoPortBinding());
+  assert(lhs.isFlat() && lhs.isComb());
+  assert(rhs.isFlat() && rhs.isComb());
+
+  if (nGroups == 1) {
+    return areEqualCombSat({ &lhs, &rhs }, nullptr,
+                           *hints.sourceBinding,
+                           *hints.targetBinding,
+                           verdicts, stop);
+  }
+
+  return areEqualCombSat({ &lhs, &rhs },
+                         *hints.sourceBinding,
+                         *hints.targetBinding,
+                         verdicts, nGroups, stop, pool);
+}
+
 bool Checker::areEqualCombSat(const std::vector<const GNet*> &nets,
                               const GateConnect *connectTo,
                               const GateBinding &ibind,
@@ -287,15 +339,220 @@ bool Checker::areEqualCombSat(const std::vector<const GNet*> &nets,
   const auto verdict = !encoder.solve();
 
   if (!verdict) {
-    error(encoder.context(), ibind, obind);
+    error(encoder.context(),
+          LinkPairs(ibind.begin(), ibind.end()),
+          LinkPairs(obind.begin(), obind.end()));
+  }
+
+  return verdict;
+}
+
+bool Checker::areEqualCombSat(const std::vector<const GNet*> &nets,
+                              const GateConnect *connectTo,
+                              const GateBinding &ibind,
+                              const GateBinding &obind,
+                              Verdicts &verdicts,
+                              bool stop) const {
+  Encoder encoder;
+  encoder.setConnectTo(connectTo);
+
+  // Encode the nets.
+  for (const auto *net : nets) {
+    encoder.encode(*net, 0);
+  }
+
+  Control control;
+  return checkOutputs(encoder,
+                      LinkPairs(ibind.begin(), ibind.end()),
+                      LinkPairs(obind.begin(), obind.end()),
+                      verdicts, stop, control);
+}
+
+bool Checker::areEqualCombSat(const std::vector<const GNet*> &nets,
+                              const GateBinding &ibind,
+                              const GateBinding &obind,
+                              Verdicts &verdicts,
+                              std::size_t nGroups,
+                              bool stop,
+                              ThreadPool &pool) const {
+  LinkPairs outputs(obind.begin(), obind.end());
+  if (outputs.empty()) {
+    return true;
+  }
+
+  if (nGroups == 0) {
+    nGroups = pool.size() + 1;
+  }
+
+  // The outputs are ordered as the gates of the first net: the adjacent
+  // outputs (likely sharing logic) are grouped together.
+  eda::utils::IdMap<Gate::Id, std::size_t> order;
+  order.reserve(nets[0]->nGates());
+  for (std::size_t k = 0; k < nets[0]->nGates(); k++) {
+    order.insert(nets[0]->gate(k)->id(), k);
+  }
+
+  const auto index = [&](Gate::Id gid) {
+    const auto *k = order.find(gid);
+    return k != nullptr ? *k : nets[0]->nGates();
+  };
+
+  std::stable_sort(outputs.begin(), outputs.end(),
+      [&index](const auto &lhs, const auto &rhs) {
+        return index(lhs.first.source) < index(rhs.first.source);
+      });
+
+  nGroups = std::min(nGroups, outputs.size());
+  const std::size_t grain = (outputs.size() + nGroups - 1) / nGroups;
+  nGroups = (outputs.size() + grain - 1) / grain;
+
+  std::vector<Verdicts> groupVerdicts(nGroups);
+  std::vector<char> groupResults(nGroups, true);
+
+  Control control;
+
+  // The gates are resolved in the storage of the calling thread.
+  auto *storage = &Gate::storage();
+
+  pool.parallelFor(outputs.size(), grain, [&](std::size_t i, std::size_t j) {
+    auto *previous = Gate::setStorage(storage);
+
+    // Collect the output cones (the triggers are cut).
+    eda::utils::IdMap<Gate::Id, char> isInCone;
+    std::vector<Gate::Id> cone;
+    std::vector<Gate::Id> stack;
+
+    for (auto k = i; k < j; k++) {
+      stack.push_back(outputs[k].first.source);
+      stack.push_back(outputs[k].second.source);
+    }
+
+    while (!stack.empty()) {
+      const auto gid = stack.back();
+      stack.pop_back();
+
+      if (!isInCone.insert(gid, 1)) continue;
+      cone.push_back(gid);
+
+      const auto *gate = Gate::get(gid);
+      if (gate->isTrigger()) continue;
+
+      for (const auto &input : gate->inputs()) {
+        stack.push_back(input.node());
+      }
+    }
+
+    // Encode the cones (only the gates of the nets).
+    Encoder encoder;
+    for (const auto gid : cone) {
+      if (std::any_of(nets.begin(), nets.end(),
+                      [gid](const GNet *net) { return net->contains(gid); })) {
+        encoder.encode(*Gate::get(gid), 0);
+      }
+    }
+
+    LinkPairs inputs;
+    for (const auto &[lhsGateLink, rhsGateLink] : ibind) {
+      if (isInCone.contains(lhsGateLink.source) ||
+          isInCone.contains(rhsGateLink.source)) {
+        inputs.emplace_back(lhsGateLink, rhsGateLink);
+      }
+    }
+
+    const LinkPairs group(outputs.begin() + i, outputs.begin() + j);
+    groupResults[i / grain] = checkOutputs(encoder, inputs, group,
+                                           groupVerdicts[i / grain],
+                                           stop, control);
+
+    Gate::setStorage(previous);
+  });
+
+  for (const auto &group : groupVerdicts) {
+    verdicts.insert(group.begin(), group.end());
+  }
+
+  return std::all_of(groupResults.begin(), groupResults.end(),
+                     [](char result) { return result; });
+}
+
+bool Checker::checkOutputs(Encoder &encoder,
+                           const LinkPairs &inputs,
+                           const LinkPairs &outputs,
+                           Verdicts &verdicts,
+                           bool stop,
+                           Control &control) const {
+  // Number of conflicts between the checks of the control flag.
+  const int64_t conflictBudget = 16 * 1024;
+
+  // Equate the inputs.
+  for (const auto &[lhsGateLink, rhsGateLink] : inputs) {
+    const auto x = encoder.var(lhsGateLink.source, 0);
+    const auto y = encoder.var(rhsGateLink.source, 0);
+
+    encoder.encodeBuf(y, x, true);
+  }
+
+  // Compare the outputs: y = (lOut[i] == rOut[i]).
+  std::vector<uint64_t> equalities;
+  equalities.reserve(outputs.size());
+
+  for (const auto &[lhsGateLink, rhsGateLink] : outputs) {
+    const auto y  = encoder.newVar();
+    const auto x1 = encoder.var(lhsGateLink.source, 0);
+    const auto x2 = encoder.var(rhsGateLink.source, 0);
+
+    encoder.encodeXor(y, x1, x2, true, true, true);
+    equalities.push_back(y);
+  }
+
+  // Check the outputs one by one under the assumption lOut[i] != rOut[i].
+  auto &solver = encoder.context().solver();
+  bool verdict = true;
+
+  Context::Clause assumption;
+  for (std::size_t i = 0; i < outputs.size() && !control.isStopped; i++) {
+    const auto y = equalities[i];
+
+    assumption.clear();
+    assumption.push(Context::lit(y, true));
+
+    // The search is resumed w/ the learnt clauses until it is stopped.
+    auto result = Minisat::l_Undef;
+    do {
+      solver.setConfBudget(conflictBudget);
+      result = solver.solveLimited(assumption);
+    } while (result == Minisat::l_Undef && !control.isStopped);
+
+    if (result == Minisat::l_Undef) {
+      break;
+    }
+
+    const bool isEqual = (result == Minisat::l_False);
+    verdicts[outputs[i].first] = isEqual;
+
+    if (isEqual) {
+      // The proven equivalence helps to check the other outputs.
+      encoder.encode(Context::lit(y, false));
+      continue;
+    }
+
+    if (!control.isReported.exchange(true)) {
+      error(encoder.context(), inputs, outputs);
+    }
+
+    verdict = false;
+    if (stop) {
+      control.isStopped = true;
+      break;
+    }
   }
 
   return verdict;
 }
 
 void Checker::error(Context &context,
-                    const GateBinding &ibind,
-                    const GateBinding &obind) const {
+                    const LinkPairs &ibind,
+                    const LinkPairs &obind) const {
   bool comma;
   context.dump("miter.cnf");
 
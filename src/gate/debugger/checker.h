@@ -11,9 +11,13 @@
 #include "gate/debugger/context.h"
 #include "gate/debugger/encoder.h"
 #include "gate/model/gnet.h"
+#include "util/thread_pool.h"
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace eda::gate::debugger {
 
@@ -24,12 +28,16 @@ namespace eda::gate::debugger {
 class Checker final {
   using Gate = eda::gate::model::Gate;
   using GNet = eda::gate::model::GNet;
+  using ThreadPool = eda::utils::ThreadPool;
 
 public:
   using GateBinding = std::unordered_map<Gate::Link, Gate::Link>;
   using SubnetBinding = std::unordered_map<GNet::SubnetId, GNet::SubnetId>;
   using GateConnect = Context::GateConnect;
 
+  /// Per-output verdicts: LHS target link -> equivalence.
+  using Verdicts = std::unordered_map<Gate::Link, bool>;
+
   /// Represents LEC hints.
   struct Hints final {
     // Known correspondence between input/output ports.
@@ -79,7 +87,37 @@ public:
                 const GNet &rhs,
                 const Hints &hints) const;
 
+  /// Checks logic equivalence of two flat combinational nets output by
+  /// output (unlike areEqual(), which checks all the outputs at once): the
+  /// miter is encoded once, and each output pair is checked by the
+  /// incremental SAT solver under the assumption that the outputs differ
+  /// (the learnt clauses are kept between the checks).
+  ///
+  /// The outputs may be split into nGroups groups (0 means the pool size
+  /// plus the calling thread): each group is encoded as a miter of its
+  /// output cones and checked in its own thread by its own solver. If
+  /// stop is set, all the checks are stopped on the first difference.
+  /// The verdicts are stored for the checked outputs.
+  bool areEqualOutputs(const GNet &lhs,
+                       const GNet &rhs,
+                       const Hints &hints,
+                       Verdicts &verdicts,
+                       std::size_t nGroups = 1,
+                       bool stop = false,
+                       ThreadPool &pool = ThreadPool::get()) const;
+
 private:
+  /// Pairs of the corresponding links.
+  using LinkPairs = std::vector<std::pair<Gate::Link, Gate::Link>>;
+
+  /// State shared by the output checks.
+  struct Control final {
+    /// Set to stop the checks (e.g., on the first difference).
+    std::atomic<bool> isStopped{false};
+    /// Set when a counterexample has been reported.
+    std::atomic<bool> isReported{false};
+  };
+
   /// Checks logic equivalence of two hierarchical nets.
   bool areEqualHier(const GNet &lhs,
                     const GNet &rhs,
@@ -119,16 +157,46 @@ private:
                        const GateBinding &ibind,
                        const GateBinding &obind) const;
 
-  /// SAT-based LEC of two flat combinational nets.
+  /// SAT-based LEC of two flat combinational nets: all the output pairs
+  /// are checked at once (the miter is satisfiable if some pair differs).
   bool areEqualCombSat(const std::vector<const GNet*> &nets,
                        const GateConnect *connectTo,
 	               const GateBinding &ibind,
 	               const GateBinding &obind) const;
 
+  /// Incremental SAT-based LEC of two flat combinational nets: the output
+  /// pairs are checked one by one (until the first difference if stop is
+  /// set); the verdicts are stored for the checked outputs.
+  bool areEqualCombSat(const std::vector<const GNet*> &nets,
+                       const GateConnect *connectTo,
+                       const GateBinding &ibind,
+                       const GateBinding &obind,
+                       Verdicts &verdicts,
+                       bool stop) const;
+
+  /// Parallel SAT-based LEC of two flat combinational nets: the groups of
+  /// the output pairs are checked in the pool threads (see areEqualOutputs()).
+  bool areEqualCombSat(const std::vector<const GNet*> &nets,
+                       const GateBinding &ibind,
+                       const GateBinding &obind,
+                       Verdicts &verdicts,
+                       std::size_t nGroups,
+                       bool stop,
+                       ThreadPool &pool) const;
+
+  /// Equates the inputs and checks the output pairs of the encoded nets
+  /// one by one (the checks are stopped when the control flag is set).
+  bool checkOutputs(Encoder &encoder,
+                    const LinkPairs &inputs,
+                    const LinkPairs &outputs,
+                    Verdicts &verdicts,
+                    bool stop,
+                    Control &control) const;
+
   /// Handles an error (prints the diagnostics, etc.).
   void error(Context &context,
-	     const GateBinding &ibind,
-	     const GateBinding &obind) const;
+	     const LinkPairs &ibind,
+	     const LinkPairs &obind) const;
 };
 
 } // namespace eda::gate::debugger
@@ -12,8 +12,10 @@
 
 #include "minisat/core/Solver.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <unordered_map>
+#include <vector>
 
 namespace eda::gate::debugger {
 
@@ -42,9 +44,13 @@ public:
     return Minisat::mkLit(static_cast<Var>(var), sign);
   }
 
-  /// Returns a variable id.
+  /// Returns a variable id (the variable is allocated on the first use).
   uint64_t var(Gate::Id gateId, uint16_t version) {
-    return reserve(var(_connectTo, gateId, version));
+    auto &var = slot(connectedTo(_connectTo, gateId), version);
+    if (var == Minisat::var_Undef) {
+      var = _solver.newVar();
+    }
+    return var;
   }
 
   /// Returns a variable id.
@@ -59,11 +65,9 @@ public:
     return var(*Gate::get(signal.node()), version, mode);
   }
 
-  /// Returns a new variable id.
+  /// Returns a new (auxiliary) variable id.
   uint64_t newVar() {
-    // See the variable id format.
-    static uint64_t var = 0;
-    return reserve(((var++) << 1) | 1);
+    return _solver.newVar();
   }
 
   /// Returns the variable value.
@@ -88,21 +92,40 @@ public:
 
 private:
   /**
-   * Returns a variable id, which is an integer of the following format:
-   *
-   * |0..0|Version|GateId|New|
-   *    2     8      20   (1)  32 bits [as is]
-   *  (16)  (16)    (31)  (1)  64 bits [to be]
-   *
-   * The version is used for symbolic execution and can borrow bits for id.
-   * The current limitations on the field widths are caused by MiniSAT.
+   * Variables of the gates of a version: the i-th entry corresponds to
+   * the gate w/ the identifier base + i. The variables are allocated in
+   * the order of the first use, so the solver size is proportional to
+   * the number of the encoded gates (rather than to the identifiers).
    */
-  static uint64_t var(const GateConnect *connectTo,
-                      Gate::Id gateId,
-                      uint16_t version) {
-    // FIXME: Such encoding is not suitable for MiniSAT w/ IntMap implemented as a vector.
-    return ((uint64_t)version << 21) |
-           ((uint64_t)connectedTo(connectTo, gateId) << 1);
+  struct VarTable final {
+    Gate::Id base = 0;
+    std::vector<Var> vars;
+  };
+
+  /// Returns the table entry for the given gate and version.
+  Var &slot(Gate::Id gateId, uint16_t version) {
+    if (version >= _vars.size()) {
+      _vars.resize(version + 1);
+    }
+
+    auto &table = _vars[version];
+    if (table.vars.empty()) {
+      table.base = gateId;
+    } else if (gateId < table.base) {
+      // The table is extended to the left (at least twice).
+      const auto grow = std::min<Gate::Id>(table.base,
+          std::max<Gate::Id>(table.base - gateId, table.vars.size()));
+      table.vars.insert(table.vars.begin(), grow, Minisat::var_Undef);
+      table.base -= grow;
+    }
+
+    const std::size_t i = gateId - table.base;
+    if (i >= table.vars.size()) {
+      table.vars.resize(std::max(i + 1, 2 * table.vars.size()),
+                        Minisat::var_Undef);
+    }
+
+    return table.vars[i];
   }
 
   /// Returns the gate id the given one is connected to.
@@ -116,15 +139,8 @@ private:
     return gateId;
   }
 
-  /// Allocates the variable in the SAT solver.
-  uint64_t reserve(uint64_t var) {
-    while (var >= (uint64_t)_solver.nVars()) {
-      _solver.newVar();
-    }
-    return var;
-  }
-
   const GateConnect *_connectTo = nullptr;
+  std::vector<VarTable> _vars;
   Solver _solver;
 };
 
@@ -23,8 +23,11 @@ void Encoder::encode(const Gate &gate, uint16_t version) {
 
   switch (gate.func()) {
   case GateSymbol::IN:
+    // Ignore input gates.
+    break;
   case GateSymbol::OUT:
-    // Ignore input and output gates.
+    // Output gates are buffers (they are used in the output bindings).
+    encodeBuf(gate, true, version);
     break;
   case GateSymbol::ONE:
     encodeFix(gate, true, version);
@@ -86,32 +89,32 @@ void Encoder::encodeBuf(const Gate &gate, bool sign, uint16_t version) {
 
 void Encoder::encodeAnd(const Gate &gate, bool sign, uint16_t version) {
   const auto y = _context.var(gate, version, Context::SET);
-  Context::Clause clause;
-  
-  clause.push(Context::lit(y, sign));
+
+  _clause.clear();
+  _clause.push(Context::lit(y, sign));
   for (const auto &input : gate.inputs()) {
     const auto x = _context.var(input, version, Context::GET);
 
-    clause.push(Context::lit(x, false));
+    _clause.push(Context::lit(x, false));
     encode(Context::lit(y, !sign), Context::lit(x, true));
   }
 
-  encode(clause);
+  encode(_clause);
 }
 
 void Encoder::encodeOr(const Gate &gate, bool sign, uint16_t version) {
   const auto y = _context.var(gate, version, Context::SET);
-  Context::Clause clause;
- 
-  clause.push(Context::lit(y, !sign));
+
+  _clause.clear();
+  _clause.push(Context::lit(y, !sign));
   for (const auto &input : gate.inputs()) {
     const auto x = _context.var(input, version, Context::GET);
 
-    clause.push(Context::lit(x, true));
+    _clause.push(Context::lit(x, true));
     encode(Context::lit(y, sign), Context::lit(x, false));
   }
 
-  encode(clause);
+  encode(_clause);
 }
 
 void Encoder::encodeXor(const Gate &gate, bool sign, uint16_t version) {
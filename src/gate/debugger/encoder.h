@@ -93,6 +93,8 @@ public:
 
 private:
   Context _context;
+  /// Clause buffer reused across the gates.
+  Context::Clause _clause;
 };
 
 } // namespace eda::gate::debugger
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/model/dnet.h"
+
+#include <algorithm>
+
+namespace eda::gate::model {
+
+DNet::DNet(const GNet &net) {
+  const size_t n = net.nGates();
+
+  _gids.resize(n);
+  _funcs.resize(n);
+  _flags.resize(n);
+  _faninOffsets.resize(n + 1);
+  _fanoutOffsets.assign(n + 1, 0);
+
+  if (n == 0) {
+    return;
+  }
+
+  // Build the identifier-to-index table.
+  _indices.reserve(n);
+
+  size_t nInputs = 0;
+  for (Index i = 0; i < n; i++) {
+    const auto *gate = net.gate(i);
+
+    _gids[i] = gate->id();
+    _indices.insert(gate->id(), i);
+
+    _faninOffsets[i] = nInputs;
+    nInputs += gate->arity();
+  }
+  _faninOffsets[n] = nInputs;
+
+  // Fill the gate arrays and the fanin arrays.
+  _fanin.resize(nInputs);
+  _events.resize(nInputs);
+
+  for (Index i = 0; i < n; i++) {
+    const auto *gate = net.gate(i);
+
+    uint8_t flags = 0;
+    if (gate->isSource())  flags |= SOURCE;
+    if (gate->isTarget())  flags |= TARGET;
+    if (gate->isValue())   flags |= VALUE;
+    if (gate->isTrigger()) flags |= TRIGGER;
+
+    const auto offset = _faninOffsets[i];
+    for (size_t j = 0; j < gate->arity(); j++) {
+      const auto &input = gate->input(j);
+      const auto source = index(input.node());
+
+      _fanin[offset + j] = source;
+      _events[offset + j] = static_cast<uint8_t>(input.event());
+
+      if (source == INVALID) {
+        flags |= BORDER;
+      } else {
+        _fanoutOffsets[source + 1]++;
+      }
+    }
+
+    _funcs[i] = gate->func();
+    _flags[i] = flags;
+  }
+
+  // Fill the fanout arrays (counting sort by the source index).
+  for (Index i = 0; i < n; i++) {
+    _fanoutOffsets[i + 1] += _fanoutOffsets[i];
+  }
+
+  _fanout.resize(_fanoutOffsets[n]);
+
+  std::vector<Index> position(_fanoutOffsets.begin(), _fanoutOffsets.end() - 1);
+  for (Index i = 0; i < n; i++) {
+    for (auto source : fanin(i)) {
+      if (source != INVALID) {
+        _fanout[position[source]++] = i;
+      }
+    }
+  }
+
+  // Collect the sources: triggers cut the combinational edges.
+  for (Index i = 0; i < n; i++) {
+    bool hasCombInputs = false;
+
+    if (!isTrigger(i)) {
+      for (auto source : fanin(i)) {
+        if (source != INVALID) {
+          hasCombInputs = true;
+          break;
+        }
+      }
+    }
+
+    if (!hasCombInputs) {
+      _sources.push_back(i);
+    }
+  }
+}
+
+} // namespace eda::gate::model
@@ -0,0 +1,247 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+#include "util/id_map.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace eda::gate::model {
+
+/**
+ * \brief Represents a gate-level net in the struct-of-arrays form
+ *        (D = dense): the gates are addressed by local indices 0..N-1,
+ *        which follow the order of GNet::gates().
+ *
+ * The net is a read-only snapshot of a GNet: function codes and flags are
+ * stored in contiguous arrays, while fanins and fanouts are stored in the
+ * CSR (compressed sparse row) form. Fanin entries referring to the gates
+ * outside the net are INVALID; fanout entries refer to the internal gates
+ * only.
+ *
+ * The snapshot is not a storage backend of GNet: the gates are still owned
+ * and modified through GNet (whose per-gate flags are kept in an IdMap).
+ * Any modification of the original net (adding, updating or removing a
+ * gate, sorting, merging or flattening) invalidates the snapshot, which
+ * should then be rebuilt.
+ */
+class DNet final {
+public:
+  //===--------------------------------------------------------------------===//
+  // Types
+  //===--------------------------------------------------------------------===//
+
+  using GateId = Gate::Id;
+  using Event  = eda::base::model::Event;
+
+  /// Local (dense) gate index.
+  using Index = uint32_t;
+  static constexpr Index INVALID = -1u;
+
+  /// Gate flags.
+  enum Flag : uint8_t {
+    /// Primary input.
+    SOURCE  = 1 << 0,
+    /// Primary output.
+    TARGET  = 1 << 1,
+    /// Constant.
+    VALUE   = 1 << 2,
+    /// Flip-flop/latch.
+    TRIGGER = 1 << 3,
+    /// Gate w/ (some) inputs from outside the net.
+    BORDER  = 1 << 4
+  };
+
+  /// View of a CSR row.
+  class Range final {
+  public:
+    using value_type = Index;
+    using const_iterator = const Index*;
+
+    Range(const Index *begin, const Index *end): _begin(begin), _end(end) {}
+
+    const_iterator begin()  const { return _begin; }
+    const_iterator end()    const { return _end; }
+    const_iterator cbegin() const { return _begin; }
+    const_iterator cend()   const { return _end; }
+
+    size_t size() const { return _end - _begin; }
+    bool empty() const { return _begin == _end; }
+
+    Index operator[](size_t i) const { return _begin[i]; }
+
+  private:
+    const Index *_begin;
+    const Index *_end;
+  };
+
+  //===--------------------------------------------------------------------===//
+  // Constructors/Destructors
+  //===--------------------------------------------------------------------===//
+
+  /// Constructs the dense representation of the given net.
+  explicit DNet(const GNet &net);
+
+  //===--------------------------------------------------------------------===//
+  // Gates
+  //===--------------------------------------------------------------------===//
+
+  /// Returns the number of gates.
+  size_t nGates() const {
+    return _gids.size();
+  }
+
+  /// Returns the number of internal connections.
+  size_t nConnects() const {
+    return _fanout.size();
+  }
+
+  /// Returns the identifier of the gate w/ the given index.
+  GateId gateId(Index i) const {
+    return _gids[i];
+  }
+
+  /// Returns the index of the given gate or INVALID.
+  Index index(GateId gid) const {
+    const auto *i = _indices.find(gid);
+    return i != nullptr ? *i : INVALID;
+  }
+
+  /// Checks whether the net contains the gate.
+  bool contains(GateId gid) const {
+    return index(gid) != INVALID;
+  }
+
+  /// Returns the function of the gate.
+  GateSymbol func(Index i) const {
+    return _funcs[i];
+  }
+
+  /// Returns the flags of the gate.
+  uint8_t flags(Index i) const {
+    return _flags[i];
+  }
+
+  bool isSource(Index i)  const { return _flags[i] & SOURCE;  }
+  bool isTarget(Index i)  const { return _flags[i] & TARGET;  }
+  bool isValue(Index i)   const { return _flags[i] & VALUE;   }
+  bool isTrigger(Index i) const { return _flags[i] & TRIGGER; }
+  bool isBorder(Index i)  const { return _flags[i] & BORDER;  }
+
+  /// Returns the number of the gate inputs.
+  size_t arity(Index i) const {
+    return _faninOffsets[i + 1] - _faninOffsets[i];
+  }
+
+  /// Returns the position of the gate's first input in the fanin array.
+  size_t faninOffset(Index i) const {
+    return _faninOffsets[i];
+  }
+
+  /// Returns the drivers of the gate inputs (INVALID for external ones).
+  Range fanin(Index i) const {
+    return row(_fanin, _faninOffsets, i);
+  }
+
+  /// Returns the event of the j-th input of the gate.
+  Event event(Index i, size_t j) const {
+    return static_cast<Event>(_events[_faninOffsets[i] + j]);
+  }
+
+  /// Returns the number of the internal gate outputs.
+  size_t fanoutSize(Index i) const {
+    return _fanoutOffsets[i + 1] - _fanoutOffsets[i];
+  }
+
+  /// Returns the internal consumers of the gate output.
+  Range fanout(Index i) const {
+    return row(_fanout, _fanoutOffsets, i);
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Graph Interface
+  //===--------------------------------------------------------------------===//
+
+  using V = Index;
+  using E = Index;
+
+  /// Returns the number of nodes.
+  size_t nNodes() const {
+    return nGates();
+  }
+
+  /// Returns the number of edges.
+  size_t nEdges() const {
+    return nConnects();
+  }
+
+  /// Checks whether the graph contains the node.
+  bool hasNode(Index v) const {
+    return v < nGates();
+  }
+
+  /// Checks whether the graph contains the edge (trigger inputs are cut).
+  bool hasEdge(Index e) const {
+    return !isTrigger(e);
+  }
+
+  /// Returns the graph sources: the gates w/o internal combinational inputs.
+  const std::vector<Index> &getSources() const {
+    return _sources;
+  }
+
+  /// Returns the outgoing edges of the node.
+  Range getOutEdges(Index v) const {
+    return fanout(v);
+  }
+
+  /// Returns the end of the edge.
+  Index leadsTo(Index e) const {
+    return e;
+  }
+
+private:
+  static Range row(const std::vector<Index> &data,
+                   const std::vector<Index> &offsets,
+                   Index i) {
+    const auto *base = data.data();
+    return Range(base + offsets[i], base + offsets[i + 1]);
+  }
+
+  /// Gate identifiers.
+  std::vector<GateId> _gids;
+  /// Gate functions.
+  std::vector<GateSymbol> _funcs;
+  /// Gate flags.
+  std::vector<uint8_t> _flags;
+
+  /// Fanin offsets (N + 1 entries).
+  std::vector<Index> _faninOffsets;
+  /// Fanin drivers.
+  std::vector<Index> _fanin;
+  /// Fanin events.
+  std::vector<uint8_t> _events;
+
+  /// Fanout offsets (N + 1 entries).
+  std::vector<Index> _fanoutOffsets;
+  /// Fanout consumers.
+  std::vector<Index> _fanout;
+
+  /// Gates w/o internal combinational inputs.
+  std::vector<Index> _sources;
+
+  /// Maps the gate identifiers to the gate indices (the table is dense
+  /// unless the identifiers are sparse).
+  eda::utils::IdMap<GateId, Index> _indices;
+};
+
+} // namespace eda::gate::model
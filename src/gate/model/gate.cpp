@@ -12,7 +12,7 @@
 
 namespace eda::gate::model {
 
-static std::ostream &operator <<(std::ostream &out, const Gate::SignalList &signals) {
+static std::ostream &operator <<(std::ostream &out, const Gate::InputList &signals) {
   bool separator = false;
   for (const Gate::Signal &signal: signals) {
     out << (separator ? ", " : "") << signal.event() << "(" << signal.node() << ")";
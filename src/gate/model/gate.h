@@ -67,7 +67,7 @@ public:
   }
 
   bool isTrigger() const {
-    for (const auto &input: _inputs) {
+    for (const auto &input: inputs()) {
       if (!input.isAlways())
         return true;
     }
@@ -94,6 +94,10 @@ private:
   }
 };
 
+// Signals and fanout entries are packed into 8 bytes.
+static_assert(sizeof(Gate::Signal) == 8);
+static_assert(sizeof(Gate::Fanout) == 8);
+
 //===----------------------------------------------------------------------===//
 // Signal Utilities
 //===----------------------------------------------------------------------===//
@@ -138,3 +142,12 @@ inline bool areContrary(const Gate::Signal &lhs, const Gate::Signal &rhs) {
 std::ostream &operator <<(std::ostream &out, const Gate &gate);
 
 } // namespace eda::gate::model
+
+namespace eda::base::model {
+
+template <>
+struct NodeType<eda::gate::model::GateSymbol> {
+  using Type = eda::gate::model::Gate;
+};
+
+} // namespace eda::base::model
@@ -6,9 +6,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "gate/model/dnet.h"
 #include "gate/model/gnet.h"
 #include "util/graph.h"
 #include "util/set.h"
+#include "util/thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
@@ -23,14 +25,17 @@ namespace eda::gate::model {
 // Constructors/Destructors 
 //===----------------------------------------------------------------------===//
 
-unsigned GNet::_counter = 0;
+std::atomic<unsigned> GNet::_counter = 0;
 
 GNet::GNet(unsigned level):
     _id(_counter++),
     _level(level),
     _nConnects(0),
+    _nOuterSourceLinks(0),
     _nGatesInSubnets(0),
-    _isSorted(true) {
+    _isSorted(true),
+    _isOrderKept(false),
+    _isBatch(false) {
   const size_t N = std::max(1024*1024 >> (5*level), 64);
   const size_t M = std::max(1024 >> level, 64);
 
@@ -47,42 +52,129 @@ GNet::GNet(unsigned level):
 // Gates 
 //===----------------------------------------------------------------------===//
 
+namespace {
+
+/// Epoch-stamped gate marks: all the marks are reset in O(1).
+class GateMarks final {
+public:
+  /// Invalidates the marks (the identifiers are less than the size).
+  void reset(size_t size) {
+    if (_marks.size() < size) {
+      _marks.resize(size, 0);
+    }
+    if (++_epoch == 0) {
+      std::fill(_marks.begin(), _marks.end(), 0);
+      _epoch = 1;
+    }
+  }
+
+  /// Checks whether the gate is marked.
+  bool has(Gate::Id gid) const {
+    return _marks[gid] == _epoch;
+  }
+
+  /// Marks the gate and returns false if it has already been marked.
+  bool mark(Gate::Id gid) {
+    if (_marks[gid] == _epoch) {
+      return false;
+    }
+    _marks[gid] = _epoch;
+    return true;
+  }
+
+private:
+  std::vector<uint32_t> _marks;
+  uint32_t _epoch = 0;
+};
+
+/// Reusable workspace for the gate-level traversals (one per thread).
+struct Traversal final {
+  GateMarks visited;
+  GateMarks targets;
+  std::vector<Gate::Id> stack;
+
+  /// Prepares the workspace for a new traversal.
+  void reset() {
+    const auto size = Gate::nextId();
+    visited.reset(size);
+    targets.reset(size);
+    stack.clear();
+  }
+};
+
+thread_local Traversal traversal;
+
+} // namespace
+
 bool GNet::hasCombFlow(GateId gid, const SignalList &inputs) const {
   if (inputs.empty() || Gate::get(gid)->isTrigger()) {
     return false;
   }
 
-  std::unordered_set<GateId> targets;
-  targets.reserve(inputs.size());
+  traversal.reset();
+
+  // The levels strictly increase along the combinational paths inside the
+  // net: if all the inputs belong to the net and no path may enter the net
+  // from the outside, the gates of the higher levels are skipped.
+  bool prune = isOrderMaintained() && _nOuterSourceLinks == 0;
+  unsigned maxLevel = 0;
 
   for (const auto input : inputs) {
-    if (gid == input.node()) {
+    const auto source = input.node();
+    if (gid == source) {
       return true;
     }
-    targets.insert(input.node());
+
+    traversal.targets.mark(source);
+
+    const auto *gate = Gate::get(source);
+    if (!contains(source)) {
+      prune = false;
+    } else if (gate->isTrigger()) {
+      // A trigger is reached via its inputs (its own level is zero).
+      for (const auto &triggerInput : gate->inputs()) {
+        if (const auto *flags = _flags.find(triggerInput.node())) {
+          maxLevel = std::max(maxLevel, flags->level + 1);
+        }
+      }
+    } else {
+      maxLevel = std::max(maxLevel, _flags.find(source)->level);
+    }
+  }
+
+  const auto isPruned = [this, prune, maxLevel](GateId gid) {
+    if (!prune) {
+      return false;
+    }
+    const auto *flags = _flags.find(gid);
+    return flags != nullptr && flags->level >= maxLevel;
+  };
+
+  if (isPruned(gid)) {
+    return false;
   }
 
-  // BFS for checking if some of the inputs are reachable.
-  std::unordered_set<GateId> reached;
-  reached.reserve(_gates.size());
+  // DFS for checking if some of the inputs are reachable.
+  auto &stack = traversal.stack;
 
-  std::queue<GateId> queue;
-  queue.push(gid);
+  stack.push_back(gid);
+  traversal.visited.mark(gid);
 
-  while (!queue.empty()) {
-    const auto *gate = Gate::get(queue.front());
-    queue.pop();
+  while (!stack.empty()) {
+    const auto *gate = Gate::get(stack.back());
+    stack.pop_back();
 
     for (auto link : gate->links()) {
       const auto target = link.target;
-      const auto status = reached.insert(target);
-
-      if (targets.find(target) != targets.end()) {
+      if (traversal.targets.has(target)) {
         return true;
       }
-
-      if (status.second && !Gate::get(target)->isTrigger()) {
-        queue.push(target);
+      if (!traversal.visited.mark(target)) {
+        continue;
+      }
+      // Triggers cut the combinational paths.
+      if (!Gate::get(target)->isTrigger() && !isPruned(target)) {
+        stack.push_back(target);
       }
     }
   }
@@ -109,13 +201,13 @@ GNet::GateId GNet::addGate(GateSymbol func, const SignalList &inputs) {
     auto *base = Gate::get(_id, baseFunc, inputs);
     if (base != nullptr) {
       addGateIfNew(base);
-      gate = Gate::get(_id, modifier, {base->id()});
+      gate = Gate::get(_id, modifier, {base->always()});
 
       if (gate != nullptr) {
         return addGateIfNew(gate);
       }
 
-      return addGate(new Gate(modifier, {base->id()}));
+      return addGate(new Gate(modifier, {base->always()}));
     }
   }
 
@@ -124,21 +216,21 @@ GNet::GateId GNet::addGate(GateSymbol func, const SignalList &inputs) {
 
 GNet::GateId GNet::addGate(Gate *gate, SubnetId sid) {
   const auto gid = gate->id();
-  assert(_flags.find(gid) == _flags.end());
+  assert(!_flags.contains(gid));
 
   unsigned gindex = _gates.size();
   _gates.push_back(gate);
 
-  GateFlags flags{0, sid, gindex};
-  _flags.insert({gid, flags});
+  GateFlags flags{0, sid, gindex, 0};
+  _flags.insert(gid, flags);
 
   onAddGate(gate, false);
 
   // Do some integrity checks.
-  assert(!(_sourceLinks.empty() &&
-           _targetLinks.empty() &&
-           _constants.empty() &&
-           _triggers.empty()));
+  assert(_isBatch || !(_sourceLinks.empty() &&
+                       _targetLinks.empty() &&
+                       _constants.empty() &&
+                       _triggers.empty()));
 
   // Structural hashing.
   Gate::add(_id, gate);
@@ -151,6 +243,13 @@ void GNet::setGate(GateId gid, GateSymbol func, const SignalList &inputs) {
   // ASSERT: Adding the given inputs does not lead to combinational cycles.
   auto *gate = Gate::get(gid);
 
+  if (_isBatch) {
+    gate->setFunc(func);
+    gate->setInputs(inputs);
+    assert(gate->invariant());
+    return;
+  }
+
   std::vector<GNet*> subnets;
   for (auto *subnet = this; subnet != nullptr;) {
     subnets.push_back(subnet);
@@ -179,15 +278,14 @@ void GNet::setGate(GateId gid, GateSymbol func, const SignalList &inputs) {
 }
 
 void GNet::removeGate(GateId gid) {
-  auto i = _flags.find(gid);
-  assert(i != _flags.end());
+  assert(_flags.contains(gid));
 
   if (_gates.size() == 1) {
     clear();
     return;
   }
 
-  const auto &flags = i->second;
+  const auto flags = getFlags(gid);
 
   // If the net is hierarchical, do it recursively.
   if (flags.subnet != INV_SUBNET) {
@@ -209,23 +307,108 @@ void GNet::removeGate(GateId gid) {
   getFlags(last->id()).gindex = flags.gindex;
 
   onRemoveGate(gate, false);
-  _flags.erase(i);
+  _flags.erase(gid);
+
+  if (isOrderMaintained()) {
+    // The last gate has been moved forward: repair the order.
+    if (last != gate) {
+      updateOrder(last);
+    }
+
+    // The levels of the former fanout may decrease.
+    GateIdList targets;
+    for (auto link : gate->links()) {
+      targets.push_back(link.target);
+    }
+    updateLevels(targets);
+  }
 
   // Do some integrity checks.
-  assert((_sourceLinks.empty() &&
-          _targetLinks.empty() &&
-          _constants.empty() &&
-          _triggers.empty()) == _gates.empty());
+  assert(_isBatch || (_sourceLinks.empty() &&
+                      _targetLinks.empty() &&
+                      _constants.empty() &&
+                      _triggers.empty()) == _gates.empty());
+}
+
+void GNet::beginBatch() {
+  assert(isFlat() && !_isBatch);
+
+  _isBatch = true;
+  _isSorted = false;
+}
+
+void GNet::finalize() {
+  assert(_isBatch);
+
+  _isBatch = false;
+
+  _sourceLinks.clear();
+  _targetLinks.clear();
+  _constants.clear();
+  _triggers.clear();
+  _nConnects = 0;
+  _nOuterSourceLinks = 0;
+
+  // The links are collected in one pass (each link is considered once).
+  bool isSorted = true;
+  for (const auto *gate : _gates) {
+    const auto gid = gate->id();
+    const auto gindex = getFlags(gid).gindex;
+
+    if (gate->isSource()) {
+      insertSourceLink(Link(gid));
+    }
+    for (size_t i = 0; i < gate->arity(); i++) {
+      const auto source = gate->input(i).node();
+      const auto *flags = _flags.find(source);
+
+      if (flags == nullptr) {
+        if (!gate->isSource()) {
+          insertSourceLink(Link(source, gid, i));
+        }
+      } else if (!gate->isTrigger() && flags->gindex >= gindex) {
+        isSorted = false;
+      }
+    }
+
+    if (gate->isTarget()) {
+      _targetLinks.insert(Link(gid));
+    } else {
+      for (auto link : gate->links()) {
+        if (!contains(link.target)) {
+          _targetLinks.insert(link);
+        }
+      }
+    }
+
+    if (gate->isValue()) {
+      _constants.insert(gid);
+    } else if (gate->isTrigger()) {
+      _triggers.insert(gid);
+    }
+
+    _nConnects += gate->arity();
+  }
+
+  // If the gates have been added in a topological order, it is kept.
+  _isSorted = isSorted;
+  if (_isSorted) {
+    computeLevels();
+  }
 }
 
 void GNet::onAddGate(Gate *gate, bool withLinks) {
+  if (_isBatch) {
+    return;
+  }
+
   const auto gid = gate->id();
 
   // Remove the links that became internal from the boundary.
   if (!withLinks) {
     // Update the source boundary.
     for (auto link : gate->links()) {
-      _sourceLinks.erase(link);
+      eraseSourceLink(link);
     }
     // Update the target boundary.
     for (size_t i = 0; i < gate->arity(); i++) {
@@ -237,13 +420,13 @@ void GNet::onAddGate(Gate *gate, bool withLinks) {
   // Add the links to the source boundary.
   if (gate->isSource()) {
     // If the gate is a pure source, add the source link.
-    _sourceLinks.insert(Link(gid));
+    insertSourceLink(Link(gid));
   } else {
     // Add the newly appeared boundary source links.
     for (size_t i = 0; i < gate->arity(); i++) {
       const auto source = gate->input(i).node();
       if (!contains(source)) {
-        _sourceLinks.insert(Link(source, gid, i));
+        insertSourceLink(Link(source, gid, i));
       }
     }
   }
@@ -269,21 +452,30 @@ void GNet::onAddGate(Gate *gate, bool withLinks) {
   }
 
   _nConnects += gate->arity();
-  _isSorted = (_gates.size() <= 1);
+
+  if (isOrderMaintained()) {
+    updateOrder(gate);
+  } else {
+    resetOrder();
+  }
 }
 
 void GNet::onRemoveGate(Gate *gate, bool withLinks) {
+  if (_isBatch) {
+    return;
+  }
+
   const auto gid = gate->id();
 
   // Remove the links from the source boundary.
   if (gate->isSource()) {
     // If the gate is a pure source, remove the source link.
-    _sourceLinks.erase(Link(gid));
+    eraseSourceLink(Link(gid));
   } else {
     // Remove the previously existing boundary source links.
     for (size_t i = 0; i < gate->arity(); i++) {
       const auto source = gate->input(i).node();
-      _sourceLinks.erase(Link(source, gid, i));
+      eraseSourceLink(Link(source, gid, i));
     }
   }
 
@@ -304,7 +496,7 @@ void GNet::onRemoveGate(Gate *gate, bool withLinks) {
     for (auto link : gate->links()) {
       const auto target = link.target;
       if (contains(target)) {
-        _sourceLinks.insert(link);
+        insertSourceLink(link);
       }
     }
     // Update the target boundary.
@@ -323,7 +515,203 @@ void GNet::onRemoveGate(Gate *gate, bool withLinks) {
   }
 
   _nConnects -= gate->arity();
+
+  // Removing edges does not break the order (the levels are updated later).
+  if (!isOrderMaintained()) {
+    resetOrder();
+  }
+}
+
+void GNet::resetOrder() {
   _isSorted = (_gates.size() <= 1);
+
+  if (_isSorted && !_gates.empty()) {
+    getFlags(_gates.front()->id()).level = 0;
+  }
+}
+
+void GNet::updateOrder(const Gate *gate) {
+  const auto gid = gate->id();
+
+  // Check the incoming edges (the trigger inputs are cut).
+  if (!gate->isTrigger()) {
+    for (const auto &input : gate->inputs()) {
+      const auto source = input.node();
+      if (contains(source)
+          && getFlags(source).gindex >= getFlags(gid).gindex
+          && !reorder(source, gid)) {
+        _isSorted = false;
+        return;
+      }
+    }
+  }
+
+  // Check the outgoing edges.
+  GateIdList targets;
+  for (auto link : gate->links()) {
+    const auto target = link.target;
+    if (!contains(target)) {
+      continue;
+    }
+
+    targets.push_back(target);
+    if (!Gate::get(target)->isTrigger()
+        && getFlags(target).gindex <= getFlags(gid).gindex
+        && !reorder(gid, target)) {
+      _isSorted = false;
+      return;
+    }
+  }
+
+  targets.push_back(gid);
+  updateLevels(targets);
+}
+
+bool GNet::reorder(GateId source, GateId target) {
+  const auto lowerBound = getFlags(target).gindex;
+  const auto upperBound = getFlags(source).gindex;
+
+  traversal.reset();
+  auto &stack = traversal.stack;
+  auto &visited = traversal.visited;
+
+  // Forward search: the gates reachable from the target.
+  GateIdList forward;
+
+  stack.push_back(target);
+  visited.mark(target);
+
+  while (!stack.empty()) {
+    const auto gid = stack.back();
+    stack.pop_back();
+    forward.push_back(gid);
+
+    for (auto link : Gate::get(gid)->links()) {
+      const auto next = link.target;
+      if (!contains(next) || Gate::get(next)->isTrigger()) {
+        continue;
+      }
+      if (next == source) {
+        // Combinational cycle.
+        return false;
+      }
+      if (getFlags(next).gindex < upperBound && visited.mark(next)) {
+        stack.push_back(next);
+      }
+    }
+  }
+
+  // Backward search: the gates the source is reachable from.
+  GateIdList backward;
+
+  stack.push_back(source);
+  visited.mark(source);
+
+  while (!stack.empty()) {
+    const auto gid = stack.back();
+    stack.pop_back();
+    backward.push_back(gid);
+
+    const auto *gate = Gate::get(gid);
+    if (gate->isTrigger()) {
+      continue;
+    }
+
+    for (const auto &input : gate->inputs()) {
+      const auto prev = input.node();
+      if (contains(prev)
+          && getFlags(prev).gindex > lowerBound
+          && visited.mark(prev)) {
+        stack.push_back(prev);
+      }
+    }
+  }
+
+  // Place the backward set before the forward set reusing the indices.
+  auto compare = [this](GateId lhs, GateId rhs) {
+    return getFlags(lhs).gindex < getFlags(rhs).gindex;
+  };
+
+  std::sort(forward.begin(), forward.end(), compare);
+  std::sort(backward.begin(), backward.end(), compare);
+
+  std::vector<unsigned> indices;
+  indices.reserve(forward.size() + backward.size());
+
+  for (auto gid : backward) {
+    indices.push_back(getFlags(gid).gindex);
+  }
+  for (auto gid : forward) {
+    indices.push_back(getFlags(gid).gindex);
+  }
+  std::sort(indices.begin(), indices.end());
+
+  size_t i = 0;
+  for (const auto *gids : {&backward, &forward}) {
+    for (auto gid : *gids) {
+      const auto gindex = indices[i++];
+      _gates[gindex] = Gate::get(gid);
+      getFlags(gid).gindex = gindex;
+    }
+  }
+
+  return true;
+}
+
+void GNet::updateLevels(const GateIdList &gids) {
+  // The gates are processed in topological order.
+  using Entry = std::pair<unsigned, GateId>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+  for (auto gid : gids) {
+    if (contains(gid)) {
+      const unsigned gindex = getFlags(gid).gindex;
+      queue.push({gindex, gid});
+    }
+  }
+
+  while (!queue.empty()) {
+    const auto gid = queue.top().second;
+    queue.pop();
+
+    const auto *gate = Gate::get(gid);
+    const auto level = computeLevel(gate);
+
+    auto &flags = getFlags(gid);
+    if (level == flags.level) {
+      continue;
+    }
+
+    flags.level = level;
+    for (auto link : gate->links()) {
+      const auto target = link.target;
+      if (contains(target)) {
+        const unsigned gindex = getFlags(target).gindex;
+        queue.push({gindex, target});
+      }
+    }
+  }
+}
+
+void GNet::computeLevels() {
+  for (const auto *gate : _gates) {
+    getFlags(gate->id()).level = computeLevel(gate);
+  }
+}
+
+unsigned GNet::computeLevel(const Gate *gate) const {
+  if (gate->isTrigger()) {
+    return 0;
+  }
+
+  unsigned level = 0;
+  for (const auto &input : gate->inputs()) {
+    if (const auto *flags = _flags.find(input.node())) {
+      level = std::max(level, flags->level + 1);
+    }
+  }
+
+  return level;
 }
 
 //===----------------------------------------------------------------------===//
@@ -353,6 +741,9 @@ void GNet::addNet(const GNet &net) {
   _nConnects += net._nConnects;
   _nGatesInSubnets += net._nGatesInSubnets;
 
+  // The order of the joint net is unknown.
+  _isSorted = false;
+
   discard_if(_sourceLinks,
     [this](Link link) { return !checkSourceLink(link); });
   for (auto link : net._sourceLinks) {
@@ -360,6 +751,9 @@ void GNet::addNet(const GNet &net) {
       _sourceLinks.insert(link);
     }
   }
+  _nOuterSourceLinks = std::count_if(
+    std::begin(_sourceLinks), std::end(_sourceLinks),
+    [](Link link) { return !link.isPort(); });
 
   discard_if(_targetLinks,
     [this](Link link) { return !checkTargetLink(link); });
@@ -369,12 +763,14 @@ void GNet::addNet(const GNet &net) {
     }
   }
 
-  for (const auto &[gid, flags] : net._flags) {
-    auto newFlags = flags;
-    newFlags.subnet += nG;
-    newFlags.gindex += nS;
+  for (const auto *gate : net._gates) {
+    auto newFlags = net.getFlags(gate->id());
+    newFlags.gindex += nG;
+    if (newFlags.subnet != INV_SUBNET) {
+      newFlags.subnet += nS;
+    }
 
-    _flags.insert({gid, newFlags});
+    _flags.insert(gate->id(), newFlags);
   }
 }
 
@@ -399,10 +795,9 @@ GNet::SubnetId GNet::addSubnet(GNet *subnet) {
 void GNet::moveGate(GateId gid, SubnetId dst) {
   assert(dst == INV_SUBNET || dst < _subnets.size());
 
-  const auto i = _flags.find(gid);
-  assert(i != _flags.end());
+  assert(_flags.contains(gid));
 
-  const auto src = i->second.subnet;
+  const auto src = getFlags(gid).subnet;
   assert(src == INV_SUBNET || src < _subnets.size());
 
   if (src == dst) 
@@ -426,7 +821,7 @@ void GNet::moveGate(GateId gid, SubnetId dst) {
     _nGatesInSubnets++;
   }
 
-  i->second.subnet = dst;
+  getFlags(gid).subnet = dst;
 }
 
 GNet::SubnetId GNet::mergeSubnets(SubnetId lhs, SubnetId rhs) {
@@ -478,8 +873,8 @@ GNet::SubnetId GNet::groupOrphans() {
 }
 
 void GNet::flatten() {
-  for (auto &[gid, flags] : _flags) {
-    flags.subnet = INV_SUBNET;
+  for (const auto *gate : _gates) {
+    getFlags(gate->id()).subnet = INV_SUBNET;
   }
 
   _subnets.clear();
@@ -529,8 +924,8 @@ void GNet::clear() {
   _subnets.clear();
   _emptySubnets.clear();
 
-  _nConnects = _nGatesInSubnets = 0;
-  _isSorted = true;
+  _nConnects = _nOuterSourceLinks = _nGatesInSubnets = 0;
+  _isSorted = !_isBatch;
 }
 
 //===----------------------------------------------------------------------===//
@@ -603,14 +998,23 @@ struct Subgraph final {
 void GNet::sortTopologically() {
   assert(isWellFormed());
 
+  // From now on, the order is maintained under the edits.
+  _isOrderKept = true;
+
   if (_isSorted)
     return;
 
   _isSorted = true;
 
+  // Large flat nets are sorted by levels.
+  if (isFlat() && _gates.size() >= LEVELIZE_THRESHOLD) {
+    sortByLevels();
+    return;
+  }
+
   // If the net is flat, sort the gates and update the indices.
   if (isFlat()) {
-    auto gates = topologicalSort<GNet>(*this);
+    auto gates = topologicalSort<GNet, FanoutList>(*this);
 
     for (size_t i = 0; i < gates.size(); i++) {
       auto gid = gates[i];
@@ -619,6 +1023,7 @@ void GNet::sortTopologically() {
       getFlags(gid).gindex = i;
     }
 
+    computeLevels();
     return;
   }
 
@@ -647,6 +1052,73 @@ void GNet::sortTopologically() {
 
     offset += subnet->nGates();
   }
+
+  computeLevels();
+}
+
+void GNet::sortByLevels() {
+  const DNet dnet(*this);
+  const auto levels =
+      graph::levelize<DNet, DNet::Range>(dnet, &ThreadPool::get());
+
+  std::vector<bool> isPlaced(dnet.nGates(), false);
+
+  size_t i = 0;
+  for (size_t level = 0; level < levels.size(); level++) {
+    for (auto index : levels[level]) {
+      const auto gid = dnet.gateId(index);
+
+      auto &flags = getFlags(gid);
+      flags.gindex = i;
+      flags.level = level;
+
+      _gates[i++] = Gate::get(gid);
+      isPlaced[index] = true;
+    }
+  }
+
+  // The gates on combinational cycles are never levelized:
+  // they are placed after the others in their original order.
+  for (DNet::Index index = 0; i < _gates.size(); index++) {
+    if (isPlaced[index]) continue;
+
+    const auto gid = dnet.gateId(index);
+
+    auto &flags = getFlags(gid);
+    flags.gindex = i;
+    flags.level = levels.size();
+
+    _gates[i++] = Gate::get(gid);
+  }
+}
+
+std::vector<GNet::GateIdList> GNet::levelize() const {
+  std::vector<GateIdList> levels;
+
+  if (_isSorted) {
+    for (const auto *gate : _gates) {
+      const auto level = getFlags(gate->id()).level;
+      if (level >= levels.size()) {
+        levels.resize(level + 1);
+      }
+      levels[level].push_back(gate->id());
+    }
+    return levels;
+  }
+
+  const DNet dnet(*this);
+  const auto indices = graph::levelize<DNet, DNet::Range>(dnet,
+                                                          &ThreadPool::get());
+
+  levels.resize(indices.size());
+  for (size_t level = 0; level < indices.size(); level++) {
+    levels[level].reserve(indices[level].size());
+    for (auto index : indices[level]) {
+      levels[level].push_back(dnet.gateId(index));
+    }
+  }
+
+  return levels;
 }
 
 //===----------------------------------------------------------------------===//
@@ -9,7 +9,10 @@
 #pragma once
 
 #include "gate/model/gate.h"
+#include "util/id_map.h"
 
+#include <atomic>
+#include <cassert>
 #include <functional>
 #include <iostream>
 #include <set>
@@ -85,6 +88,7 @@ public:
   using SubnetIdSet = std::set<SubnetId>;
   using Link        = Gate::Link;
   using LinkList    = Gate::LinkList;
+  using FanoutList  = Gate::FanoutList;
   using LinkSet     = std::unordered_set<Link>;
   using Signal      = Gate::Signal;
   using SignalList  = Gate::SignalList;
@@ -100,6 +104,8 @@ public:
     unsigned subnet : 20;
     /// Local index of the gate.
     unsigned gindex : 32;
+    /// Logic level of the gate (valid if the net is sorted).
+    unsigned level  : 32;
   };
   #pragma pack(pop)
 
@@ -112,6 +118,9 @@ public:
   /// Maximum subnet index (max. 2^20 - 1 subnets).
   static constexpr SubnetId MAX_SUBNET = INV_SUBNET - 1;
 
+  /// Minimum size of a flat net to be sorted by parallel levelization.
+  static constexpr size_t LEVELIZE_THRESHOLD = 64 * 1024;
+
   //===--------------------------------------------------------------------===//
   // Constructors/Destructors
   //===--------------------------------------------------------------------===//
@@ -161,6 +170,10 @@ public:
   }
 
   /// Checks whether the net is topologically sorted.
+  ///
+  /// Flat nets keep the order (and the gate levels) under the edits
+  /// once they are explicitly sorted (see sortTopologically()); nets being
+  /// built are not; hierarchical nets should be re-sorted.
   bool isSorted() const {
     return _isSorted;
   }
@@ -249,7 +262,15 @@ public:
 
   /// Checks whether the net contains the gate.
   bool contains(GateId gid) const {
-    return _flags.find(gid) != _flags.end();
+    return _flags.contains(gid);
+  }
+
+  /// Returns the logic level of the gate: 0 for the gates w/o internal
+  /// combinational inputs (including triggers), 1 + the maximum level
+  /// of the internal inputs otherwise (valid if the net is sorted).
+  unsigned gateLevel(GateId gid) const {
+    assert(_isSorted);
+    return getFlags(gid).level;
   }
 
   /// Checks whether the net has the source link.
@@ -272,7 +293,9 @@ public:
     return _triggers.find(gid) != _triggers.end();
   }
 
-  /// Checks if any of the given inputs depends on the given gate.
+  /// Checks if any of the given inputs depends on the given gate (the
+  /// paths may go through the gates outside the net, but not through the
+  /// triggers; an input that is a trigger may be reached).
   bool hasCombFlow(GateId gid, const SignalList &inputs) const;
 
   /// Adds a new (empty) gate and returns its identifier.
@@ -289,6 +312,24 @@ public:
   /// Removes the gate from the net.
   void removeGate(GateId gid);
 
+  //===--------------------------------------------------------------------===//
+  // Batch Construction
+  //===--------------------------------------------------------------------===//
+
+  /// Starts the batch mode for the flat net: the gates are added, modified,
+  /// and removed w/o maintaining the boundary (source/target links,
+  /// constants, triggers, and connections) and the order.
+  void beginBatch();
+
+  /// Ends the batch mode: computes the boundary and checks the gate order
+  /// (the levels are computed if the gates are topologically sorted).
+  void finalize();
+
+  /// Checks whether the net is in the batch mode (the boundary is invalid).
+  bool isBatch() const {
+    return _isBatch;
+  }
+
   //===--------------------------------------------------------------------===//
   // Convenience Methods
   //===--------------------------------------------------------------------===//
@@ -490,7 +531,7 @@ public:
   }
 
   /// Returns the outgoing edges of the node.
-  const LinkList &getOutEdges(GateId gid) const {
+  FanoutList getOutEdges(GateId gid) const {
     return Gate::get(gid)->links();
   }
 
@@ -506,6 +547,10 @@ public:
   /// Sorts the gates in topological order.
   void sortTopologically();
 
+  /// Returns the gates grouped by levels (see gateLevel()). The levels of
+  /// a sorted net are known; otherwise, they are computed in parallel.
+  std::vector<GateIdList> levelize() const;
+
 private:
   //===--------------------------------------------------------------------===//
   // Internal Methods
@@ -528,12 +573,12 @@ private:
 
   /// Returns a copy of the gate flags.
   GateFlags getFlags(GateId gid) const {
-    return _flags.find(gid)->second;
+    return *_flags.find(gid);
   }
 
   /// Returns the reference to the gate flags.
   GateFlags &getFlags(GateId gid) {
-    return _flags.find(gid)->second;
+    return *_flags.find(gid);
   }
 
   /// Checks whether the link is a source link.
@@ -541,6 +586,20 @@ private:
     return link.isPort() || !contains(link.source);
   }
 
+  /// Adds the link to the source boundary.
+  void insertSourceLink(const Link &link) {
+    if (_sourceLinks.insert(link).second && !link.isPort()) {
+      _nOuterSourceLinks++;
+    }
+  }
+
+  /// Removes the link from the source boundary.
+  void eraseSourceLink(const Link &link) {
+    if (_sourceLinks.erase(link) != 0 && !link.isPort()) {
+      _nOuterSourceLinks--;
+    }
+  }
+
   /// Checks whether the link is a target link.
   bool checkTargetLink(const Link &link) const {
     return link.isPort() || !contains(link.target);
@@ -551,6 +610,35 @@ private:
   /// Updates the net state when removing a gate.
   void onRemoveGate(Gate *gate, bool withLinks);
 
+  /// Checks whether the order is maintained incrementally (it is enabled
+  /// by the first sortTopologically(), so building a net is not slowed).
+  bool isOrderMaintained() const {
+    return _isSorted && _isOrderKept && isFlat();
+  }
+
+  /// Resets the order of the net after a hierarchical edit.
+  void resetOrder();
+
+  /// Restores the topological order after adding/modifying the gate.
+  void updateOrder(const Gate *gate);
+
+  /// Reorders the gates for the newly added edge (source, target),
+  /// which violates the order (the Pearce-Kelly algorithm).
+  /// Returns false if the edge closes a combinational cycle.
+  bool reorder(GateId source, GateId target);
+
+  /// Recomputes the levels of the given gates and their fanout cones.
+  void updateLevels(const GateIdList &gids);
+
+  /// Computes the levels of all gates (the net should be sorted).
+  void computeLevels();
+
+  /// Sorts the gates by levels (parallel levelization of a flat net).
+  void sortByLevels();
+
+  /// Computes the level of the gate (the inputs' levels are known).
+  unsigned computeLevel(const Gate *gate) const;
+
   //===--------------------------------------------------------------------===//
   // Internal Fields
   //===--------------------------------------------------------------------===//
@@ -563,8 +651,8 @@ private:
   /// Gates of the net.
   Gate::List _gates;
 
-  /// Gate flags.
-  std::unordered_map<GateId, GateFlags> _flags;
+  /// Gate flags (a dense array while the gate identifiers are compact).
+  eda::utils::IdMap<GateId, GateFlags> _flags;
 
   /// Input links: {(external gate, internal gate, internal input)}.
   LinkSet _sourceLinks;
@@ -578,6 +666,8 @@ private:
 
   /// Number of connections.
   size_t _nConnects;
+  /// Number of the source links from the gates outside the net.
+  size_t _nOuterSourceLinks;
 
   /// All subnets including the empty ones.
   List _subnets;
@@ -589,9 +679,13 @@ private:
 
   /// Flag indicating that the net is topologically sorted.
   bool _isSorted;
+  /// Flag indicating that the net has been explicitly sorted.
+  bool _isOrderKept;
+  /// Flag indicating that the net is in the batch mode.
+  bool _isBatch;
 
-  /// Counter for identifier initialization.
-  static unsigned _counter;
+  /// Counter for identifier initialization (shared among the threads).
+  static std::atomic<unsigned> _counter;
 };
 
 /// Outputs the net.
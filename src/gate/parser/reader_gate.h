@@ -155,7 +155,7 @@ public:
   void print() const {
     for (auto &gate: data->gnet.gates()) {
       std::cout << gate->id() << " :\n"; // << " " << gate->kind()
-      for (auto &link: gate->links()) {
+      for (auto link: gate->links()) {
         std::cout << "\t( " << link.source << " ) " << link.target << "\n";
       }
     }
@@ -174,7 +174,7 @@ public:
   void dot(std::ofstream &stream) const {
     stream << "digraph gnet {\n";
     for (const auto &gate: data->gnet.gates()) {
-      for (auto &links: gate->links()) {
+      for (auto links: gate->links()) {
         stream << "\t";
         print(stream, gate);
         stream << " -> ";
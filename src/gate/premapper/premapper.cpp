@@ -17,7 +17,7 @@ using Gate = eda::gate::model::Gate;
 using GNet = eda::gate::model::GNet;
 
 Gate::SignalList getNewInputs(
-    const Gate::SignalList &oldInputs,
+    const Gate::InputList &oldInputs,
     const PreMapper::GateIdMap &oldToNewGates) {
   Gate::SignalList newInputs(oldInputs.size());
 
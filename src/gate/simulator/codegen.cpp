@@ -0,0 +1,380 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/simulator/simulator.h"
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace eda::gate::simulator {
+
+using Compiled = Simulator::Compiled;
+
+/// Name of the entry point of the generated code.
+static constexpr const char *ENTRY = "utopia_simulate";
+/// Version of the generated code (a part of the cache key).
+static constexpr std::uint64_t VERSION = 2;
+/// Maximum number of statements in a generated function.
+static constexpr std::size_t CHUNK = 256;
+
+void Compiled::executeNative(Compiled &c, State &s) {
+  c.native(c.value(s, 0), s.next.data()->words, s.postponed.data());
+  s.nPostponed = s.postponed.size();
+}
+
+std::uint64_t Compiled::hash() const {
+  // FNV-1a over the bytecode.
+  std::uint64_t h = 0xcbf29ce484222325ull ^ VERSION;
+  auto mix = [&h](std::uint64_t x) {
+    h ^= x;
+    h *= 0x100000001b3ull;
+  };
+
+  mix(state.memory.size());
+  mix(state.postponed.size());
+  for (const auto word : code) {
+    mix(word);
+  }
+
+  return h;
+}
+
+std::string Compiled::signature() const {
+  std::string result;
+  auto append = [&result](const void *data, std::size_t size) {
+    result.append(static_cast<const char*>(data), size);
+  };
+
+  const std::uint64_t header[] = {
+    VERSION, state.memory.size(), state.postponed.size()
+  };
+
+  append(header, sizeof(header));
+  append(code.data(), code.size() * sizeof(C));
+
+  return result;
+}
+
+std::string Compiled::generate() const {
+  std::stringstream out;
+
+  out << "// Generated by the Utopia EDA simulator. Do not edit.\n"
+      << "#include <cstddef>\n"
+      << "#include <cstdint>\n\n"
+      << "typedef std::uint64_t W;\n"
+      << "typedef std::size_t I;\n";
+
+  auto ref = [](C i) {
+    return "m[" + std::to_string(i) + "]";
+  };
+
+  auto fold = [&ref](const char *op, const C *in, C arity) {
+    std::string result = ref(in[0]);
+    for (C i = 1; i < arity; i++) {
+      result += std::string(" ") + op + " " + ref(in[i]);
+    }
+    return result;
+  };
+
+  std::size_t nFunctions = 0;
+  std::size_t nStatements = CHUNK;
+  std::size_t nTriggers = 0;
+
+  for (const C *pc = code.data(); pc != code.data() + code.size();) {
+    const auto op = pc[0];
+    const auto arity = pc[1];
+    const auto target = pc[2];
+    const auto lhs = ref(target);
+    const C *in = pc + 3;
+
+    pc = in + arity;
+
+    // Split the code into functions (for the sake of the system compiler).
+    if (nStatements == CHUNK) {
+      out << (nFunctions ? "}\n" : "") << "\nstatic void f" << nFunctions
+          << "(W *__restrict m, W *__restrict n, I *__restrict p) {\n";
+      nFunctions++;
+      nStatements = 0;
+    }
+    nStatements++;
+
+    out << "  ";
+    switch (op) {
+    case ZERO  : out << lhs << " = 0;";                               break;
+    case ONE   : out << lhs << " = ~W(0);";                           break;
+    case NOP   : out << lhs << " = " << ref(in[0]) << ";";            break;
+    case NOT   : out << lhs << " = ~" << ref(in[0]) << ";";           break;
+    case AND2  :
+    case AND   : out << lhs << " = " << fold("&", in, arity) << ";";  break;
+    case OR2   :
+    case OR    : out << lhs << " = " << fold("|", in, arity) << ";";  break;
+    case XOR2  :
+    case XOR   : out << lhs << " = " << fold("^", in, arity) << ";";  break;
+    case NAND2 :
+    case NAND  : out << lhs << " = ~(" << fold("&", in, arity) << ");"; break;
+    case NOR2  :
+    case NOR   : out << lhs << " = ~(" << fold("|", in, arity) << ");"; break;
+    case XNOR2 :
+    case XNOR  : out << lhs << " = ~(" << fold("^", in, arity) << ");"; break;
+    case LATCH : {
+      const auto d = ref(in[0]), ena = ref(in[1]);
+      out << "n[" << nTriggers << "] = (" << d << " & " << ena << ") | ("
+          << lhs << " & ~" << ena << "); p[" << nTriggers << "] = "
+          << target << ";";
+      nTriggers++;
+      break;
+    }
+    case DFF   : {
+      const auto d = ref(in[0]), clk = ref(in[1]), prev = ref(in[2]);
+      out << "{ const W e = " << clk << " & ~" << prev << "; " << prev
+          << " = " << clk << "; n[" << nTriggers << "] = (" << d
+          << " & e) | (" << lhs << " & ~e); p[" << nTriggers << "] = "
+          << target << "; }";
+      nTriggers++;
+      break;
+    }
+    case DFFrs : {
+      const auto d = ref(in[0]), clk = ref(in[1]), prev = ref(in[4]);
+      const auto rst = ref(in[2]), set = ref(in[3]);
+      out << "{ const W e = " << clk << " & ~" << prev << "; " << prev
+          << " = " << clk << "; n[" << nTriggers << "] = ~" << rst << " & ("
+          << set << " | (" << d << " & e) | (" << lhs << " & ~e)); p["
+          << nTriggers << "] = " << target << "; }";
+      nTriggers++;
+      break;
+    }
+    default:
+      assert(false);
+    }
+    out << "\n";
+  }
+
+  if (nFunctions) {
+    out << "}\n";
+  }
+
+  assert(nTriggers == state.postponed.size());
+
+  out << "\nextern \"C\" void " << ENTRY << "(W *m, W *n, I *p) {\n";
+  for (std::size_t i = 0; i < nFunctions; i++) {
+    out << "  f" << i << "(m, n, p);\n";
+  }
+  out << "}\n";
+
+  return out.str();
+}
+
+/// Returns the directory for the cached shared objects.
+static fs::path getCacheDir() {
+  const char *dir = std::getenv("UTOPIA_SIM_CACHE");
+  if (dir != nullptr && *dir != '\0') {
+    return fs::path(dir);
+  }
+
+  const char *xdg = std::getenv("XDG_CACHE_HOME");
+  if (xdg != nullptr && *xdg != '\0') {
+    return fs::path(xdg) / "utopia-sim";
+  }
+
+  return fs::path("/tmp") / ("utopia-sim-" + std::to_string(getuid()));
+}
+
+/// Creates the cache directory (if required) and checks that it is private:
+/// the loaded objects are executed, so no one else may put them there.
+static bool openCacheDir(const fs::path &dir) {
+  std::error_code error;
+  fs::create_directories(dir.parent_path(), error);
+
+  if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+    return false;
+  }
+
+  // The directory itself (not a symbolic link) is checked.
+  struct stat info;
+  if (lstat(dir.c_str(), &info) != 0) {
+    return false;
+  }
+
+  return S_ISDIR(info.st_mode)
+      && info.st_uid == getuid()
+      && (info.st_mode & (S_IRWXG | S_IRWXO)) == 0;
+}
+
+/// Returns a suffix for the temporary files unique among the threads
+/// and the processes.
+static std::string getTempSuffix() {
+  static std::atomic<std::uint64_t> counter = 0;
+  return std::to_string(getpid()) + "." + std::to_string(counter++);
+}
+
+/// Checks whether the file holds exactly the given data.
+static bool hasData(const fs::path &path, const std::string &data) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+
+  const std::string contents((std::istreambuf_iterator<char>(in)),
+                              std::istreambuf_iterator<char>());
+  return contents == data;
+}
+
+/// Writes the file under a temporary name and then renames it.
+static bool putData(const fs::path &path, const std::string &data) {
+  const fs::path temp = path.string() + "." + getTempSuffix();
+  {
+    std::ofstream out(temp, std::ios::binary);
+    out << data;
+    if (!out) {
+      return false;
+    }
+  }
+
+  std::error_code error;
+  fs::rename(temp, path, error);
+  return !error;
+}
+
+/// Builds the shared object from the source file. The compiler is run
+/// directly (w/o the shell): $CXX is split into words by whitespace.
+static bool build(const fs::path &source, const fs::path &library) {
+  const char *cxx = std::getenv("CXX");
+
+  std::vector<std::string> args;
+  std::istringstream words((cxx != nullptr && *cxx != '\0') ? cxx : "c++");
+  for (std::string word; words >> word;) {
+    args.push_back(word);
+  }
+  if (args.empty()) {
+    return false;
+  }
+
+  args.insert(args.end(), {
+    "-std=c++17", "-O1", "-shared", "-fPIC",
+    "-o", library.string(), source.string()
+  });
+
+  std::vector<char*> argv;
+  for (auto &arg : args) {
+    argv.push_back(arg.data());
+  }
+  argv.push_back(nullptr);
+
+  // The compiler output is discarded.
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null",
+                                   O_WRONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+
+  pid_t pid;
+  const int status = posix_spawnp(&pid, argv[0], &actions, nullptr,
+                                  argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+
+  if (status != 0) {
+    return false;
+  }
+
+  int result;
+  while (waitpid(pid, &result, 0) == -1) {
+    if (errno != EINTR) {
+      return false;
+    }
+  }
+
+  return WIFEXITED(result) && WEXITSTATUS(result) == 0;
+}
+
+bool Compiled::loadNative() {
+  assert(blockSize == 1);
+
+  std::stringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash();
+
+  std::error_code error;
+  const auto dir = getCacheDir();
+  if (!openCacheDir(dir)) {
+    return false;
+  }
+
+  // The cached object is keyed by the hash; the program signature is stored
+  // next to it and compared before loading (the hashes may collide).
+  const auto library = dir / (key.str() + ".so");
+  const auto sigfile = dir / (key.str() + ".sig");
+  const auto sig = signature();
+
+  void *handle = nullptr;
+  if (fs::exists(library, error) && hasData(sigfile, sig)) {
+    handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+  } else {
+    // The object is built and loaded under a temporary name (concurrent
+    // builds do not interfere) and then moved to the cache.
+    const auto suffix = getTempSuffix();
+    const auto source = dir / (key.str() + "." + suffix + ".cpp");
+    const auto temp = dir / (key.str() + "." + suffix + ".so");
+    {
+      std::ofstream out(source);
+      out << generate();
+      if (!out) {
+        fs::remove(source, error);
+        return false;
+      }
+    }
+
+    const bool built = build(source, temp);
+    fs::remove(source, error);
+
+    if (built) {
+      handle = dlopen(temp.c_str(), RTLD_NOW | RTLD_LOCAL);
+    }
+
+    // On a hash collision, the cached object is kept (the loaded one is
+    // removed from the disk; its code stays mapped).
+    if (handle != nullptr && !fs::exists(library, error)
+                          && putData(sigfile, sig)) {
+      fs::rename(temp, library, error);
+    }
+    fs::remove(temp, error);
+  }
+
+  if (handle == nullptr) {
+    return false;
+  }
+
+  auto *entry = reinterpret_cast<Native>(dlsym(handle, ENTRY));
+  if (entry == nullptr) {
+    dlclose(handle);
+    return false;
+  }
+
+  this->library = std::shared_ptr<void>(handle, dlclose);
+  this->native = entry;
+  this->executor = executeNative;
+
+  return true;
+}
+
+} // namespace eda::gate::simulator
@@ -8,99 +8,811 @@
 
 #include "gate/simulator/simulator.h"
 
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
 namespace eda::gate::simulator {
 
 using Compiled = Simulator::Compiled;
 
-Compiled::OP Compiled::getOp(const Gate &gate) const {
-  using GateSymbol = eda::gate::model::GateSymbol;
-
-  const auto n = gate.arity();
-
-  switch (gate.func()) {
-  case GateSymbol::OUT   : return getNop(n);
-  case GateSymbol::ZERO  : return getZero(n);
-  case GateSymbol::ONE   : return getOne(n);
-  case GateSymbol::NOP   : return getNop(n);
-  case GateSymbol::NOT   : return getNot(n);
-  case GateSymbol::AND   : return getAnd(n);
-  case GateSymbol::OR    : return getOr(n);
-  case GateSymbol::XOR   : return getXor(n);
-  case GateSymbol::NAND  : return getNand(n);
-  case GateSymbol::NOR   : return getNor(n);
-  case GateSymbol::XNOR  : return getXnor(n);
-  case GateSymbol::LATCH : return getLatch(n);
-  case GateSymbol::DFF   : return getDff(n);
-  case GateSymbol::DFFrs : return getDffrs(n);
+//===----------------------------------------------------------------------===//
+// Kernels
+//===----------------------------------------------------------------------===//
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define UTOPIA_SIMD_X86
+#endif
+
+// Vectors of words (the memory is aligned to the cache line).
+typedef Compiled::W W4 __attribute__((vector_size(32)));
+typedef Compiled::W W8 __attribute__((vector_size(64)));
+
+template <typename V>
+__attribute__((always_inline)) inline const Compiled::C *Compiled::eval(
+    State &s, const C *pc, V *m, V *next) {
+  const V zero = V{};
+  const V ones = ~zero;
+
+  const auto op = pc[0];
+  const auto arity = pc[1];
+  const auto out = pc[2];
+  const C *in = pc + 3;
+
+  switch (op) {
+  case ZERO  : m[out] = zero;                  break;
+  case ONE   : m[out] = ones;                  break;
+  case NOP   : m[out] = m[in[0]];              break;
+  case NOT   : m[out] = ~m[in[0]];             break;
+  case AND2  : m[out] = m[in[0]] & m[in[1]];   break;
+  case OR2   : m[out] = m[in[0]] | m[in[1]];   break;
+  case XOR2  : m[out] = m[in[0]] ^ m[in[1]];   break;
+  case NAND2 : m[out] = ~(m[in[0]] & m[in[1]]); break;
+  case NOR2  : m[out] = ~(m[in[0]] | m[in[1]]); break;
+  case XNOR2 : m[out] = ~(m[in[0]] ^ m[in[1]]); break;
+  case AND   :
+  case NAND  : {
+    V result = ones;
+    for (C i = 0; i < arity; i++) {
+      result &= m[in[i]];
+    }
+    m[out] = (op == AND) ? result : ~result;
+    break;
+  }
+  case OR    :
+  case NOR   : {
+    V result = zero;
+    for (C i = 0; i < arity; i++) {
+      result |= m[in[i]];
+    }
+    m[out] = (op == OR) ? result : ~result;
+    break;
+  }
+  case XOR   :
+  case XNOR  : {
+    V result = zero;
+    for (C i = 0; i < arity; i++) {
+      result ^= m[in[i]];
+    }
+    m[out] = (op == XOR) ? result : ~result;
+    break;
+  }
+  case LATCH : {
+    // The patterns w/o the enable signal keep the old values.
+    const V ena = m[in[1]];
+    next[s.nPostponed] = (m[in[0]] & ena) | (m[out] & ~ena);
+    s.postponed[s.nPostponed++] = out;
+    break;
+  }
+  case DFF   : {
+    // The patterns w/o the clock edge keep the old values.
+    const V clk = m[in[1]];
+    const V edge = clk & ~m[in[2]];
+    m[in[2]] = clk;
+
+    next[s.nPostponed] = (m[in[0]] & edge) | (m[out] & ~edge);
+    s.postponed[s.nPostponed++] = out;
+    break;
+  }
+  case DFFrs : {
+    const V clk = m[in[1]];
+    const V rst = m[in[2]];
+    const V set = m[in[3]];
+    const V edge = clk & ~m[in[4]];
+    m[in[4]] = clk;
+
+    // Priorities: reset, set, clock.
+    const V d = (m[in[0]] & edge) | (m[out] & ~edge);
+    next[s.nPostponed] = ~rst & (set | d);
+    s.postponed[s.nPostponed++] = out;
+    break;
+  }
+  default:
+    assert(false);
+  }
+
+  return in + arity;
+}
+
+template <typename V>
+__attribute__((always_inline)) inline void Compiled::execute(
+    State &s, const C *pc, const C *end) {
+  static_assert(alignof(Line) % alignof(V) == 0);
+
+  V *m = reinterpret_cast<V*>(s.memory.data());
+  V *next = reinterpret_cast<V*>(s.next.data());
+
+  while (pc != end) {
+    pc = eval<V>(s, pc, m, next);
+  }
+}
+
+void Compiled::executeAll(Compiled &c, State &s) {
+  c.kernel(s, c.code.data(), c.code.data() + c.code.size());
+}
+
+void Compiled::executeEvents(Compiled &c, State &s) {
+  auto &e = c.events;
+
+  W *m = c.value(s, 0);
+  W *next = s.next.data()->words;
+
+  auto schedule = [&e](C i) {
+    if (!e.scheduled[i]) {
+      e.scheduled[i] = 1;
+      e.wheel[e.levels[i]].push_back(i);
+    }
+  };
+
+  auto scheduleFanout = [&e, &schedule](I slot) {
+    for (I j = e.fanoutBegin[slot]; j < e.fanoutBegin[slot + 1]; j++) {
+      schedule(e.fanout[j]);
+    }
+  };
+
+  if (!e.isInitialized) {
+    // All the instructions are evaluated in the first pass.
+    for (C i = 0; i < e.offsets.size(); i++) {
+      schedule(i);
+    }
+    e.isInitialized = true;
+  }
+
+  // Detect the changes of the inputs and the trigger outputs.
+  for (I i = 0; i < e.boundary.size(); i++) {
+    const auto slot = e.boundary[i];
+    if (m[slot] != e.shadow[i]) {
+      e.shadow[i] = m[slot];
+      scheduleFanout(slot);
+    }
+  }
+
+  // Propagate the changes level by level.
+  e.nEvaluated = 0;
+  for (auto &bucket : e.wheel) {
+    for (I k = 0; k < bucket.size(); k++) {
+      const auto i = bucket[k];
+      const C *pc = c.code.data() + e.offsets[i];
+      const auto out = pc[2];
+      const W old = m[out];
+
+      e.scheduled[i] = 0;
+      e.nEvaluated++;
+      eval<W>(s, pc, m, next);
+
+      // The trigger outputs are updated in the next pass.
+      if (m[out] != old) {
+        scheduleFanout(out);
+      }
+    }
+    bucket.clear();
+  }
+}
+
+/// Instantiations of the kernel for the block types and the instruction sets.
+struct Kernels final {
+  using State = Compiled::State;
+  using C = Compiled::C;
+
+  static void w1(State &s, const C *pc, const C *end) {
+    Compiled::execute<Compiled::W>(s, pc, end);
+  }
+  static void w4(State &s, const C *pc, const C *end) {
+    Compiled::execute<W4>(s, pc, end);
+  }
+  static void w8(State &s, const C *pc, const C *end) {
+    Compiled::execute<W8>(s, pc, end);
+  }
+
+#ifdef UTOPIA_SIMD_X86
+  __attribute__((target("avx2")))
+  static void avx2w4(State &s, const C *pc, const C *end) {
+    Compiled::execute<W4>(s, pc, end);
+  }
+
+  __attribute__((target("avx2")))
+  static void avx2w8(State &s, const C *pc, const C *end) {
+    Compiled::execute<W8>(s, pc, end);
+  }
+
+  __attribute__((target("avx512f")))
+  static void avx512w8(State &s, const C *pc, const C *end) {
+    Compiled::execute<W8>(s, pc, end);
+  }
+#endif // UTOPIA_SIMD_X86
+};
+
+Compiled::I Compiled::nativeWords() {
+#ifdef UTOPIA_SIMD_X86
+  if (__builtin_cpu_supports("avx512f")) {
+    return 8;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return 4;
+  }
+#endif // UTOPIA_SIMD_X86
+  return 1;
+}
+
+Compiled::Kernel Compiled::getKernel(I nWords) {
+  const auto native = nativeWords();
+
+  switch (nWords) {
+  case 1:
+    return Kernels::w1;
+#ifdef UTOPIA_SIMD_X86
+  case 4:
+    return native >= 4 ? Kernels::avx2w4 : Kernels::w4;
+  case 8:
+    return native >= 8 ? Kernels::avx512w8
+         : native >= 4 ? Kernels::avx2w8
+                       : Kernels::w8;
+#else
+  case 4:
+    return Kernels::w4;
+  case 8:
+    return Kernels::w8;
+#endif // UTOPIA_SIMD_X86
+  default:
+    assert(false && "Unsupported block size");
+  }
+
+  return Kernels::w1;
+}
+
+void Compiled::getPatterns(WV &in, std::uint64_t base, I nWords) {
+  assert(base % WIDTH == 0);
+  assert(in.size() % nWords == 0);
+
+  // Lane masks for the lower inputs: the j-th lane holds the j-th pattern.
+  static constexpr W lanes[] = {
+    0xaaaaaaaaaaaaaaaaull,
+    0xccccccccccccccccull,
+    0xf0f0f0f0f0f0f0f0ull,
+    0xff00ff00ff00ff00ull,
+    0xffff0000ffff0000ull,
+    0xffffffff00000000ull
+  };
+
+  for (I i = 0; i < in.size() / nWords; i++) {
+    for (I j = 0; j < nWords; j++) {
+      const auto word = base + j * WIDTH;
+      if (i < std::size(lanes)) {
+        in[i * nWords + j] = lanes[i];
+      } else {
+        in[i * nWords + j] = ((word >> i) & 1) ? ONES : 0;
+      }
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Compilation
+//===----------------------------------------------------------------------===//
+
+Compiled::Opcode Compiled::getOpcode(GateSymbol func, I n) {
+  switch (func) {
+  case GateSymbol::OUT   : return NOP;
+  case GateSymbol::ZERO  : return ZERO;
+  case GateSymbol::ONE   : return ONE;
+  case GateSymbol::NOP   : return NOP;
+  case GateSymbol::NOT   : return NOT;
+  case GateSymbol::AND   : return n == 1 ? NOP : n == 2 ? AND2  : AND;
+  case GateSymbol::OR    : return n == 1 ? NOP : n == 2 ? OR2   : OR;
+  case GateSymbol::XOR   : return n == 1 ? NOP : n == 2 ? XOR2  : XOR;
+  case GateSymbol::NAND  : return n == 1 ? NOT : n == 2 ? NAND2 : NAND;
+  case GateSymbol::NOR   : return n == 1 ? NOT : n == 2 ? NOR2  : NOR;
+  case GateSymbol::XNOR  : return n == 1 ? NOT : n == 2 ? XNOR2 : XNOR;
+  case GateSymbol::LATCH : return LATCH;
+  case GateSymbol::DFF   : return DFF;
+  case GateSymbol::DFFrs : return DFFrs;
   default: assert(false);
   }
 
-  return getZero(0);
+  return ZERO;
 }
 
-Compiled::Command Compiled::getCommand(const GNet &net,
-                                       const Gate &gate) const {
-  const auto op = getOp(gate);
+void Compiled::emit(const DNet &net,
+                    DNet::Index target,
+                    const std::vector<C> &slots) {
+  using eda::base::model::LEVEL0;
+  using eda::base::model::NEGEDGE;
+
+  const auto arity = net.arity(target);
+  const auto op = getOpcode(net.func(target), arity);
+  const auto fanin = net.fanin(target);
+
+  // The external inputs are stored after the gates (see the constructor).
+  auto getSlot = [&](I i) {
+    const auto source = fanin[i];
+    return source != DNet::INVALID
+        ? slots[source]
+        : slots[net.nGates() + net.faninOffset(target) + i];
+  };
 
-  const auto target = gate.id();
-  Gate::Link outLink(target);
-  const auto out = gindex.find(outLink)->second;
+  if (!isTrigger(op)) {
+    code.push_back(op);
+    code.push_back(arity);
+    code.push_back(slots[target]);
 
-  IV in(gate.arity());
-  for (I i = 0; i < gate.arity(); i++) {
-    const auto source = gate.input(i).node();
+    for (I i = 0; i < arity; i++) {
+      code.push_back(getSlot(i));
+    }
 
-    Gate::Link inLink = net.contains(source)
-                      ? Gate::Link(source)
-                      : Gate::Link(source, target, i);
+    return;
+  }
+
+  // Triggers: d, ena (LATCH); d, clk, prev (DFF); d, clk, rst, set, prev
+  // (DFFrs). The clock/enable/reset/set signals are of positive polarity
+  // (the negative ones are inverted into the extra values); prev is the
+  // extra value holding the clock of the last evaluation.
+  C inputs[5];
+  assert(arity < std::size(inputs));
+
+  for (I i = 0; i < arity; i++) {
+    const auto event = net.event(target, i);
+    inputs[i] = getSlot(i);
 
-    in[i] = gindex.find(inLink)->second;
+    if (event == NEGEDGE || event == LEVEL0) {
+      code.insert(code.end(), {NOT, 1, static_cast<C>(nSlots), inputs[i]});
+      inputs[i] = nSlots++;
+    }
   }
 
-  return Command{op, out, in};
+  const bool hasClock = (op != LATCH);
+  if (hasClock) {
+    // The clocks are initially low (an inverted clock is high).
+    setValue(state, nSlots, net.event(target, 1) == NEGEDGE);
+    inputs[arity] = nSlots++;
+  }
+
+  code.push_back(op);
+  code.push_back(arity + hasClock);
+  code.push_back(slots[target]);
+  code.insert(code.end(), inputs, inputs + arity + hasClock);
 }
 
 Compiled::Compiled(const GNet &net,
                    const GNet::LinkList &in,
-                   const GNet::LinkList &out):
-    program(net.nGates()),
+                   const GNet::LinkList &out,
+                   I nWords):
     nInputs(in.size()),
+    nSlots(0),
     outputs(out.size()),
-    memory(net.nSourceLinks() + net.nGates()),
-    postponed(net.nTriggers()),
-    nPostponed(0) {
+    blockSize(nWords),
+    kernel(getKernel(nWords)),
+    executor(executeAll),
+    native(nullptr),
+    // Each trigger may require up to 5 extra values (see emit()).
+    state{std::vector<Line>(nLines(net.nSourceLinks() + net.nGates()
+                                   + 5 * net.nTriggers())),
+          IV(net.nTriggers()),
+          std::vector<Line>(nLines(net.nTriggers())),
+          0} {
 
   assert(net.isSorted() && "Net is not topologically sorted");
   assert(net.nSourceLinks() == in.size());
+  assert(net.nSourceLinks() + net.nGates() <= std::numeric_limits<C>::max());
+
+  // The dense snapshot of the net (the gates are indexed in the order of
+  // net.gates()); it is released after the compilation.
+  const DNet dnet(net);
+  const auto nGates = dnet.nGates();
 
-  gindex.reserve(net.nSourceLinks() + net.nGates());
+  // Memory indices: the gate outputs, then the external inputs of the gates
+  // (in the order of the fanin offsets).
+  std::vector<C> slots(nGates + dnet.faninOffset(nGates), NONE);
+
+  auto getSlot = [&](const Gate::Link &link) -> C& {
+    if (link.isPort()) {
+      return slots[dnet.index(link.source)];
+    }
+    const auto target = dnet.index(link.target);
+    return slots[nGates + dnet.faninOffset(target) + link.input];
+  };
 
   // Map the source links (including source gates) to memory.
-  I i = 0;
-  for (const auto link : in) {
-    gindex[link] = i++;
+  C i = 0;
+  for (const auto &link : in) {
+    if (!link.isPort()) {
+      // Keep the positions of the source links (see getIndex()).
+      const auto *offset = sourceOffsets.find(link.target);
+      if (offset == nullptr) {
+        sourceOffsets.insert(link.target, sourceInputs.size());
+        offset = sourceOffsets.find(link.target);
+        sourceInputs.resize(sourceInputs.size()
+                            + Gate::get(link.target)->arity(), NONE);
+      }
+      sourceInputs[*offset + link.input] = i;
+    }
+    getSlot(link) = i++;
   }
 
   // Map the non-source gates to memory.
-  for (const auto *gate : net.gates()) {
-    if (gate->isSource()) continue;
-    Gate::Link link(gate->id());
-    gindex[link] = i++;
+  for (DNet::Index k = 0; k < nGates; k++) {
+    if (!dnet.isSource(k)) {
+      slots[k] = i++;
+    }
+  }
+  nSlots = i;
+
+  // Determine the output indices.
+  for (I k = 0; k < out.size(); k++) {
+    outputs[k] = getSlot(out[k]);
   }
 
-  // Determine the output indices. 
-  i = 0;
-  for (const auto link : out) {
-    outputs[i++] = gindex[link];
+  // Compose the simulation program: the triggers are evaluated after the
+  // combinational gates (so that they sample the values of the same pass).
+  code.reserve(3 * nGates + dnet.faninOffset(nGates));
+  for (const bool isTrigger : {false, true}) {
+    for (DNet::Index k = 0; k < nGates; k++) {
+      if (dnet.isSource(k) || dnet.isTrigger(k) != isTrigger) continue;
+      emit(dnet, k, slots);
+    }
   }
 
-  // Compose the simulation program.
-  i = 0;
-  for (const auto *gate : net.gates()) {
-    if (gate->isSource()) continue;
-    program[i++] = getCommand(net, *gate);
+  // Release the unused extra values (see emit()).
+  state.memory.resize(nLines(nSlots));
+
+  // Keep the memory indices of the gates (see getIndex()).
+  gateSlots.reserve(nGates);
+  for (DNet::Index k = 0; k < nGates; k++) {
+    gateSlots.insert(dnet.gateId(k), slots[k]);
   }
-  program.resize(i);
+}
+
+Compiled::I Compiled::getIndex(const Gate::Link &link) const {
+  if (!link.isPort()) {
+    const auto *offset = sourceOffsets.find(link.target);
+    assert(offset != nullptr && "Unknown source link");
+
+    const auto i = sourceInputs[*offset + link.input];
+    assert(i != NONE && "Unknown source link");
+    return i;
+  }
+
+  const auto *i = gateSlots.find(link.source);
+  assert(i != nullptr && "Unknown gate");
+
+  assert(*i != NONE && "Value is not kept in memory");
+  return *i;
+}
+
+void Compiled::getLevels(IV &offsets, std::vector<C> &levels) const {
+  offsets.clear();
+  levels.clear();
+
+  // The combinational instructions refer to the preceding ones.
+  std::vector<C> slotLevels(nSlots, 0);
+  for (const C *pc = code.data(); pc != code.data() + code.size();) {
+    const auto op = pc[0];
+    const auto arity = pc[1];
+
+    C level = 0;
+    for (C j = 0; j < arity; j++) {
+      level = std::max(level, slotLevels[pc[3 + j]]);
+    }
+
+    offsets.push_back(pc - code.data());
+    levels.push_back(level + 1);
+
+    if (!isTrigger(op)) {
+      slotLevels[pc[2]] = level + 1;
+    }
+
+    pc += 3 + arity;
+  }
+}
+
+void Compiled::initEvents() {
+  assert(blockSize == 1);
+
+  auto &e = events;
+
+  getLevels(e.offsets, e.levels);
+
+  // Count the fanouts.
+  IV count(nSlots + 1, 0);
+  IV triggers;
+  for (const auto offset : e.offsets) {
+    const C *pc = code.data() + offset;
+    const auto arity = pc[1];
+
+    if (isTrigger(pc[0])) {
+      triggers.push_back(pc[2]);
+    }
+    for (C j = 0; j < arity; j++) {
+      count[pc[3 + j]]++;
+    }
+  }
+
+  e.fanoutBegin.assign(nSlots + 1, 0);
+  for (I i = 0; i < nSlots; i++) {
+    e.fanoutBegin[i + 1] = e.fanoutBegin[i] + count[i];
+  }
+
+  e.fanout.resize(e.fanoutBegin[nSlots]);
+  std::copy(e.fanoutBegin.begin(), e.fanoutBegin.end() - 1, count.begin());
+
+  for (C i = 0; i < e.offsets.size(); i++) {
+    const C *pc = code.data() + e.offsets[i];
+    const auto arity = pc[1];
+
+    for (C j = 0; j < arity; j++) {
+      e.fanout[count[pc[3 + j]]++] = i;
+    }
+  }
+
+  // The boundary: the inputs and the trigger outputs.
+  for (I i = 0; i < nInputs; i++) {
+    e.boundary.push_back(i);
+  }
+  e.boundary.insert(e.boundary.end(), triggers.begin(), triggers.end());
+  e.shadow.assign(e.boundary.size(), 0);
+
+  const C maxLevel = e.levels.empty()
+      ? 0 : *std::max_element(e.levels.begin(), e.levels.end());
+
+  e.wheel.resize(maxLevel + 1);
+  e.scheduled.assign(e.offsets.size(), 0);
+
+  executor = executeEvents;
+}
+
+void Compiled::initLevels(ThreadPool &pool) {
+  IV offsets;
+  std::vector<C> levels;
+  getLevels(offsets, levels);
+
+  // The triggers are placed after all the combinational instructions.
+  const C nLevels = levels.empty()
+      ? 0 : *std::max_element(levels.begin(), levels.end());
+
+  for (I i = 0; i < offsets.size(); i++) {
+    if (isTrigger(code[offsets[i]])) {
+      levels[i] = nLevels + 1;
+    }
+  }
+
+  IV order(offsets.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&levels](I lhs, I rhs) {
+    return levels[lhs] < levels[rhs];
+  });
+
+  // Reorder the program (the instructions of a level are independent).
+  auto &p = parallel;
+
+  CV reordered;
+  reordered.reserve(code.size());
+
+  for (I i = 0; i < order.size(); i++) {
+    const auto level = levels[order[i]];
+    if (level <= nLevels && (i == 0 || level != levels[order[i - 1]])) {
+      p.levelBegin.push_back(i);
+    }
+
+    const C *pc = code.data() + offsets[order[i]];
+    p.offsets.push_back(reordered.size());
+    reordered.insert(reordered.end(), pc, pc + 3 + pc[1]);
+  }
+
+  const auto nCombinational = std::count_if(levels.begin(), levels.end(),
+      [nLevels](C level) { return level <= nLevels; });
+
+  p.levelBegin.push_back(nCombinational);
+  p.offsets.push_back(reordered.size());
+  p.pool = &pool;
+
+  code = std::move(reordered);
+  executor = executeLevels;
+}
+
+//===----------------------------------------------------------------------===//
+// Memory Allocation
+//===----------------------------------------------------------------------===//
+
+void Compiled::reuseSlots() {
+  assert(!isEventDriven() && !isLevelParallel() && !isNative());
+  assert(state.nPostponed == 0);
+
+  constexpr I PINNED = std::numeric_limits<I>::max();
+
+  // Instruction offsets.
+  IV offsets;
+  for (I pc = 0; pc < code.size(); pc += 3 + code[pc + 1]) {
+    offsets.push_back(pc);
+  }
+
+  // The last use of each value: the instruction index + 1 (0 - unused).
+  IV lastUse(nSlots, 0);
+  for (I k = 0; k < offsets.size(); k++) {
+    const C *pc = code.data() + offsets[k];
+    for (C j = 0; j < pc[1]; j++) {
+      lastUse[pc[3 + j]] = k + 1;
+    }
+  }
+
+  // The values living across the passes are pinned: the inputs, the
+  // outputs, the trigger outputs, and the clocks of the last evaluation.
+  std::fill_n(lastUse.begin(), nInputs, PINNED);
+  for (const auto i : outputs) {
+    lastUse[i] = PINNED;
+  }
+  for (const auto offset : offsets) {
+    const C *pc = code.data() + offset;
+    if (isTrigger(pc[0])) {
+      lastUse[pc[2]] = PINNED;
+      if (pc[0] != LATCH) {
+        lastUse[pc[2 + pc[1]]] = PINNED;
+      }
+    }
+  }
+
+  // The pinned values are placed first (the inputs keep their indices).
+  std::vector<C> slots(nSlots, NONE);
+  C nUsed = 0;
+  for (I i = 0; i < nSlots; i++) {
+    if (lastUse[i] == PINNED) {
+      slots[i] = nUsed++;
+    }
+  }
+
+  // The recently released slots are reused first (they are in the cache).
+  std::vector<C> released;
+  for (I k = 0; k < offsets.size(); k++) {
+    C *pc = code.data() + offsets[k];
+
+    for (C j = 0; j < pc[1]; j++) {
+      const auto i = pc[3 + j];
+      pc[3 + j] = slots[i];
+
+      if (lastUse[i] == k + 1) {
+        released.push_back(slots[i]);
+        lastUse[i] = 0;
+      }
+    }
+
+    // The output may take the slot of a dead input (it is read before).
+    const auto i = pc[2];
+    if (slots[i] == NONE) {
+      if (released.empty()) {
+        slots[i] = nUsed++;
+      } else {
+        slots[i] = released.back();
+        released.pop_back();
+      }
+      if (lastUse[i] == 0) {
+        released.push_back(slots[i]);
+      }
+    }
+    pc[2] = slots[i];
+  }
+
+  for (auto &i : outputs) {
+    i = slots[i];
+  }
+
+  // The internal values are not observable anymore.
+  gateSlots.forEach([&slots, &lastUse](Gate::Id, C &i) {
+    if (i != NONE) {
+      i = (lastUse[i] == PINNED) ? slots[i] : NONE;
+    }
+  });
+
+  // Move the initial values of the pinned slots.
+  std::vector<Line> memory(nLines(nUsed));
+  for (I i = 0; i < nSlots; i++) {
+    if (lastUse[i] == PINNED) {
+      std::copy_n(value(state, i), blockSize,
+                  memory.data()->words + slots[i] * blockSize);
+    }
+  }
+
+  state.memory = std::move(memory);
+  nSlots = nUsed;
+}
+
+//===----------------------------------------------------------------------===//
+// Sequential Simulation
+//===----------------------------------------------------------------------===//
+
+void Compiled::run(I nCycles,
+                   const Stimulus &stimulus,
+                   const Response &response) {
+  // The output buffer is reused across the cycles.
+  WV out(outputs.size() * blockSize);
+
+  // The oscillations (via transparent latches) are cut.
+  const I maxPasses = state.postponed.size() + 1;
+
+  setTriggers(state);
+  for (I cycle = 0; cycle < nCycles; cycle++) {
+    stimulus(cycle, value(state, 0));
+
+    for (I pass = 0; pass < maxPasses; pass++) {
+      executor(*this, state);
+      if (!updateTriggers(state)) {
+        break;
+      }
+    }
+
+    getTargets(state, out.data());
+    response(cycle, out.data());
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Parallel Simulation
+//===----------------------------------------------------------------------===//
+
+void Compiled::executeLevels(Compiled &c, State &s) {
+  // Number of the instructions evaluated by a task.
+  constexpr I grain = 1024;
+
+  const auto &p = c.parallel;
+  const C *code = c.code.data();
+
+  for (I k = 0; k + 1 < p.levelBegin.size(); k++) {
+    const auto begin = p.levelBegin[k];
+    const auto end = p.levelBegin[k + 1];
+
+    // The pool returns when all the tasks are done (a barrier).
+    p.pool->parallelFor(end - begin, grain, [&](I i, I j) {
+      c.kernel(s, code + p.offsets[begin + i], code + p.offsets[begin + j]);
+    });
+  }
+
+  // The triggers are evaluated sequentially (the postponed assignments).
+  c.kernel(s, code + p.offsets[p.levelBegin.back()], code + c.code.size());
+}
+
+Compiled::Stats Compiled::simulateBatch(WV &out,
+                                        const WV &in,
+                                        I nThreads,
+                                        ThreadPool &pool) {
+  assert(!isEventDriven() && "Event-driven simulation is sequential");
+  assert(nInputs > 0);
+
+  const I inSize = nInputs * blockSize;
+  const I outSize = outputs.size() * blockSize;
+  const I nBlocks = in.size() / inSize;
+
+  assert(in.size() == nBlocks * inSize);
+  assert(out.size() == nBlocks * outSize);
+
+  if (nThreads == 0) {
+    nThreads = pool.size() + 1;
+  }
+
+  // A chunk of blocks per thread.
+  const I nTasks = std::max<I>(1, std::min(nThreads, nBlocks));
+  const I grain = (nBlocks + nTasks - 1) / nTasks;
+
+  // The blocks are evaluated sequentially by the threads: the levels of
+  // a level-parallel program are not spread over the (busy) pool again.
+  const Executor execute = isLevelParallel() ? executeAll : executor;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  pool.parallelFor(nBlocks, grain, [&](I begin, I end) {
+    // The thread's own memory initialized w/ the current state.
+    State local = state;
+    setTriggers(local);
+
+    for (I k = begin; k < end; k++) {
+      setSources(local, in.data() + k * inSize);
+      execute(*this, local);
+      getTargets(local, out.data() + k * outSize);
+      local.nPostponed = 0;
+    }
+  });
+
+  const std::chrono::duration<double> time =
+      std::chrono::steady_clock::now() - start;
+
+  return Stats{nBlocks * nPatterns(), nTasks, time.count()};
 }
 
 } // namespace eda::gate::simulator
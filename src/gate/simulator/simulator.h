@@ -8,413 +8,526 @@
 
 #pragma once
 
+#include "gate/model/dnet.h"
 #include "gate/model/gnet.h"
+#include "util/id_map.h"
+#include "util/thread_pool.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace eda::gate::simulator {
 
 /**
  * \brief Implements a simple simulator of (synchronous) gate-level nets.
+ *
+ * The values are bit-parallel: one pass over the compiled program
+ * evaluates up to 64 input patterns per word. A program may be compiled
+ * for blocks of several words (e.g., 4 or 8 words for AVX2 or AVX-512):
+ * the kernel is selected at runtime depending on the CPU features.
+ * Alternatively, a program may be translated to C++, built by the system
+ * compiler, and loaded as a shared object (see compileNative()), or
+ * simulated in the event-driven mode (see compileEventDriven()). Large
+ * batches of patterns are split across threads (see simulateBatch());
+ * wide nets may be evaluated level by level in parallel (see
+ * compileLevelParallel()). The memory of deep nets may be compacted by
+ * reusing the slots of dead values (see compileCompact()). Sequential
+ * nets are simulated cycle by cycle w/ edge-triggered flip-flops (see
+ * Compiled::run()).
  * \author <a href="mailto:kamkin@ispras.ru">Alexander Kamkin</a>
  */
 class Simulator final {
+  using DNet = eda::gate::model::DNet;
   using Gate = eda::gate::model::Gate;
+  using GateSymbol = eda::gate::model::GateSymbol;
   using GNet = eda::gate::model::GNet;
+  using ThreadPool = eda::utils::ThreadPool;
 
 public:
   /// Representation of a gate-level net optimized for simulation.
   class Compiled final {
     friend class Simulator;
+    friend struct Kernels;
 
     Compiled(const GNet &net,
              const GNet::LinkList &in,
-             const GNet::LinkList &out);
+             const GNet::LinkList &out,
+             std::size_t nWords);
 
   public:
     using B  = bool;
     using BV = std::vector<B>;
     using I  = std::size_t;
     using IV = std::vector<I>;
+    using W  = std::uint64_t;
+    using WV = std::vector<W>;
+
+    /// Number of patterns simulated in parallel per word.
+    static constexpr I WIDTH = 64;
+
+    /// Returns the widest block (in words) supported by the CPU vector
+    /// extensions: 8 (AVX-512), 4 (AVX2), or 1 (portable code).
+    static I nativeWords();
 
     /// Returns the number of inputs.
     I nSources() const { return nInputs; }
     /// Returns the number of outputs.
     I nTargets() const { return outputs.size(); }
+    /// Returns the number of words per value.
+    I nWords() const { return blockSize; }
+    /// Returns the number of patterns simulated in parallel.
+    I nPatterns() const { return WIDTH * blockSize; }
+    /// Returns the number of values in memory.
+    I nValues() const { return nSlots; }
+    /// Checks whether the program is executed as native code.
+    bool isNative() const { return library != nullptr; }
+    /// Checks whether the program is simulated in the event-driven mode.
+    bool isEventDriven() const { return executor == executeEvents; }
+    /// Checks whether the levels are evaluated in parallel.
+    bool isLevelParallel() const { return executor == executeLevels; }
+    /// Returns the number of gates evaluated in the last event-driven pass.
+    I nEvaluated() const { return events.nEvaluated; }
+
+    /// Returns the memory index of the source link or the gate link (in
+    /// compacted programs, only inputs, outputs, and triggers are kept).
+    I getIndex(const Gate::Link &link) const;
+    /// Returns the current value (nWords() words) of the given index.
+    const W *getValue(I index) const {
+      return state.memory.data()->words + index * blockSize;
+    }
 
-    /// Evaluates the outputs from the inputs.
+    /// Evaluates the outputs from the inputs:
+    /// BV            - a single pattern (a value per input/output);
+    /// std::uint64_t - a single pattern (a bit per input/output);
+    /// WV            - nPatterns() patterns (nWords() consecutive words
+    ///                 per input/output).
     template <typename T = BV>
     void simulate(T &out, const T &in) { 
-      setTriggers();
-      setSources(in);
-      execute();
-      getTargets(out);
-    }
-
-  private:
-    /// Sets the input values.
-    void setSources(const BV &values) {
-      assert(values.size() == nInputs);
-      for (I i = 0; i < nInputs; i++) {
-        memory[i] = values[i];
-      }
-    }
-
-    /// Sets the input values.
-    void setSources(std::uint64_t values) {
-      assert(nInputs <= 64);
-      for (I i = 0; i < nInputs; i++) {
-        memory[i] = (values >> i) & 1;
-      }
-    }
-
-    /// Executes the postponed assignments.
-    void setTriggers() {
-      while (nPostponed > 0) {
-        const auto assign = postponed[--nPostponed];
-        const auto lhs = assign.first;
-        const auto rhs = assign.second;
-
-        memory[lhs] = rhs;
-      }
-    }
-
-    /// Gets the output values.
-    void getTargets(BV &values) {
-      assert(values.size() == outputs.size());
-      for (I i = 0; i < outputs.size(); i++) {
-        values[i] = memory[outputs[i]];
-      }
+      setTriggers(state);
+      setSources(state, in);
+      executor(*this, state);
+      getTargets(state, out);
     }
 
-    /// Gets the output values.
-    void getTargets(std::uint64_t &values) {
-      assert(outputs.size() <= 64);
-      values = 0;
-      for (I i = 0; i < outputs.size(); i++) {
-        values |= (memory[outputs[i]] << i);
-      }
+    /// Fills the input values of the given cycle (nSources() * nWords()
+    /// words laid out as in the WV simulate()).
+    using Stimulus = std::function<void(I cycle, W *in)>;
+    /// Handles the output values of the given cycle (nTargets() * nWords()
+    /// words laid out as in the WV simulate()).
+    using Response = std::function<void(I cycle, const W *out)>;
+
+    /// Simulates the given number of cycles. In each cycle, the stimulus
+    /// is applied, and the values are propagated until the triggers are
+    /// stable: DFFs sample the inputs on the clock edges (w.r.t. the clock
+    /// values of the previous cycle; the clocks are initially low), latches
+    /// are transparent while enabled, DFFrs set/reset are asynchronous.
+    /// Then the response is called (no allocations are done per cycle).
+    /// Combinational loops through transparent latches are evaluated at
+    /// most nTriggers + 1 times per cycle.
+    void run(I nCycles, const Stimulus &stimulus, const Response &response);
+
+    /// Simulates the given number of cycles: the input (output) values of
+    /// the i-th cycle are stored as in the WV simulate() starting from
+    /// i * nSources() * nWords() (i * nTargets() * nWords()).
+    void run(I nCycles, const WV &in, WV &out) {
+      const I inSize = nInputs * blockSize;
+      const I outSize = outputs.size() * blockSize;
+
+      assert(in.size() == nCycles * inSize);
+      assert(out.size() == nCycles * outSize);
+
+      run(nCycles,
+          [&](I cycle, W *values) {
+            std::copy_n(in.data() + cycle * inSize, inSize, values);
+          },
+          [&](I cycle, const W *values) {
+            std::copy_n(values, outSize, out.data() + cycle * outSize);
+          });
     }
 
-    /// Executes the compiled program.
-    void execute() {
-      for (auto &command : program) {
-        command.op(command.out, command.in);
+    /// Statistics of a batch simulation.
+    struct Stats final {
+      /// Number of the simulated patterns.
+      I nPatterns;
+      /// Number of the threads involved.
+      I nThreads;
+      /// Elapsed time (in seconds).
+      double seconds;
+
+      /// Returns the simulation throughput.
+      double patternsPerSecond() const {
+        return seconds > 0 ? nPatterns / seconds : 0;
       }
-    }
-
-    /// Gate function (operation).
-    using OP = std::function<void(I, IV)>;
-
-    /// Single command.
-    struct Command final {
-      OP op;  // Operation.
-      I  out; // Output.
-      IV in;  // Inputs.
     };
 
-    /// Returns the gate function.
-    OP getOp(const Gate &gate) const;
-    /// Construct the command for the given gate.
-    Command getCommand(const GNet &net, const Gate &gate) const;
+    /// Evaluates the outputs for a batch of nPatterns()-pattern blocks:
+    /// the input (output) values of the k-th block are stored as in the
+    /// WV simulate() starting from k * nSources() * nWords() (k * nTargets()
+    /// * nWords()). The blocks are split across nThreads threads of the
+    /// pool (0 means the pool size plus the calling thread); each thread
+    /// has its own memory, the program is shared. The trigger values are
+    /// taken from the current state and are not updated.
+    Stats simulateBatch(WV &out,
+                        const WV &in,
+                        I nThreads = 0,
+                        ThreadPool &pool = ThreadPool::get());
+
+    /// Fills the inputs w/ nWords * WIDTH consecutive patterns of the
+    /// exhaustive enumeration starting from the given one (the i-th input
+    /// value is the i-th bit of the pattern index).
+    static void getPatterns(WV &in, std::uint64_t base, I nWords = 1);
 
-    /// Compiled program for the given net.
-    std::vector<Command> program;
-    /// Number of the program inputs.
-    I nInputs;
-    /// Program outputs: indices in memory (see below).
-    IV outputs;
-
-    /// Holds the state: first, inputs; then, internal gates.
-    BV memory;
-
-    /// Postponed assignments (for triggers).
-    std::vector<std::pair<I, B>> postponed;
-    /// Number of postponed assignments.
-    I nPostponed;
-
-    /// Maps source links and gates to memory indices.
-    std::unordered_map<Gate::Link, I> gindex;
-
-    //------------------------------------------------------------------------//
-    // ZERO
-    //------------------------------------------------------------------------//
-
-    const OP opZero = [this](I out, IV in) {
-      memory[out] = 0;
-    };
-
-    OP getZero(I arity) const { return opZero; }
-
-    //------------------------------------------------------------------------//
-    // ONE
-    //------------------------------------------------------------------------//
-
-    const OP opOne = [this](I out, IV in) {
-      memory[out] = 1;
-    };
-
-    OP getOne(I arity) const { return opOne; }
-
-    //------------------------------------------------------------------------//
-    // NOP
-    //------------------------------------------------------------------------//
-
-    const OP opNop = [this](I out, IV in) {
-      memory[out] = memory[in[0]];
-    };
-
-    OP getNop(I arity) const { return opNop; }
-
-    //------------------------------------------------------------------------//
-    // NOT
-    //------------------------------------------------------------------------//
+  private:
+    /// All-ones word.
+    static constexpr W ONES = ~W{0};
 
-    const OP opNot = [this](I out, IV in) {
-      memory[out] = !memory[in[0]];
+    /// Storage unit aligned for the vector kernels.
+    struct alignas(64) Line final {
+      W words[8];
     };
 
-    OP getNot(I arity) const { return opNot; }
-
-    //------------------------------------------------------------------------//
-    // AND
-    //------------------------------------------------------------------------//
-
-    const OP opAnd2 = [this](I out, IV in) {
-      memory[out] = memory[in[0]] && memory[in[1]];
-    };
+    /// Returns the number of lines for storing the given number of values.
+    I nLines(I nValues) const {
+      return (nValues * blockSize + 7) / 8;
+    }
 
-    const OP opAnd3 = [this](I out, IV in) {
-      memory[out] = memory[in[0]] && memory[in[1]] && memory[in[2]];
+    /// Simulation state (the program is shared by the states).
+    struct State final {
+      /// Holds the values: first, inputs; then, internal gates.
+      /// Each value is a block of words (WIDTH patterns per word).
+      std::vector<Line> memory;
+      /// Postponed assignments (for triggers): indices and values.
+      IV postponed;
+      std::vector<Line> next;
+      /// Number of postponed assignments.
+      I nPostponed;
     };
 
-    const OP opAndN = [this](I out, IV in) {
-      for (auto i : in) {
-        if (!memory[i]) {
-          memory[out] = 0;
-          return;
-        }
-      }
-      memory[out] = 1;
-    };
-
-    OP getAnd(I arity) const {
-      switch (arity) {
-      case  1: return opNop;
-      case  2: return opAnd2;
-      case  3: return opAnd3;
-      default: return opAndN;
-      }
+    /// Returns the first word of the value.
+    W *value(State &s, I i) const {
+      return s.memory.data()->words + i * blockSize;
     }
 
-    //------------------------------------------------------------------------//
-    // OR
-    //------------------------------------------------------------------------//
-
-    const OP opOr2 = [this](I out, IV in) {
-      memory[out] = memory[in[0]] || memory[in[1]];
-    };
-
-    const OP opOr3 = [this](I out, IV in) {
-      memory[out] = memory[in[0]] || memory[in[1]] || memory[in[3]];
-    };
+    /// Sets the value (all the patterns).
+    void setValue(State &s, I i, B bit) const {
+      std::fill_n(value(s, i), blockSize, bit ? ONES : 0);
+    }
 
-    const OP opOrN = [this](I out, IV in) {
-      for (auto i : in) {
-        if (memory[i]) {
-          memory[out] = 1;
-          return;
-        }
+    /// Sets the input values.
+    void setSources(State &s, const BV &values) const {
+      assert(values.size() == nInputs);
+      for (I i = 0; i < nInputs; i++) {
+        setValue(s, i, values[i]);
       }
-      memory[out] = 0;
-    };
+    }
 
-    OP getOr(I arity) const {
-      switch (arity) {
-      case  1: return opNop;
-      case  2: return opOr2;
-      case  3: return opOr3;
-      default: return opOrN;
+    /// Sets the input values.
+    void setSources(State &s, std::uint64_t values) const {
+      assert(nInputs <= 64);
+      for (I i = 0; i < nInputs; i++) {
+        setValue(s, i, (values >> i) & 1);
       }
     }
 
-    //------------------------------------------------------------------------//
-    // XOR
-    //------------------------------------------------------------------------//
-
-    const OP opXor2 = [this](I out, IV in) {
-      memory[out] = memory[in[0]] ^ memory[in[1]];
-    };
-
-    const OP opXor3 = [this](I out, IV in) {
-      memory[out] = memory[in[0]] ^ memory[in[1]] ^ memory[in[2]];
-    };
+    /// Sets the input values (nPatterns() patterns).
+    void setSources(State &s, const WV &values) const {
+      assert(values.size() == nInputs * blockSize);
+      setSources(s, values.data());
+    }
 
-    const OP opXorN = [this](I out, IV in) {
-      bool result = 0;
-      for (auto i : in) {
-        result ^= memory[i];
-      }
-      memory[out] = result;
-    };
+    /// Sets the input values (nPatterns() patterns).
+    void setSources(State &s, const W *values) const {
+      std::copy_n(values, nInputs * blockSize, value(s, 0));
+    }
 
-    OP getXor(I arity) const {
-      switch (arity) {
-      case  1: return opNop;
-      case  2: return opXor2;
-      case  3: return opXor3;
-      default: return opXorN;
+    /// Executes the postponed assignments.
+    void setTriggers(State &s) const {
+      while (s.nPostponed > 0) {
+        s.nPostponed--;
+        std::copy_n(s.next.data()->words + s.nPostponed * blockSize,
+                    blockSize, value(s, s.postponed[s.nPostponed]));
       }
     }
 
-    //------------------------------------------------------------------------//
-    // NAND
-    //------------------------------------------------------------------------//
-
-    const OP opNand2 = [this](I out, IV in) {
-      memory[out] = !(memory[in[0]] && memory[in[1]]);
-    };
-
-    const OP opNand3 = [this](I out, IV in) {
-      memory[out] = !(memory[in[0]] && memory[in[1]] && memory[in[2]]);
-    };
-
-    const OP opNandN = [this](I out, IV in) {
-      for (auto i : in) {
-        if (!memory[i]) {
-          memory[out] = 1;
-          return;
+    /// Executes the postponed assignments and checks for changes.
+    bool updateTriggers(State &s) const {
+      bool isChanged = false;
+      while (s.nPostponed > 0) {
+        s.nPostponed--;
+        const W *next = s.next.data()->words + s.nPostponed * blockSize;
+        W *current = value(s, s.postponed[s.nPostponed]);
+
+        if (!std::equal(next, next + blockSize, current)) {
+          std::copy_n(next, blockSize, current);
+          isChanged = true;
         }
       }
-      memory[out] = 0;
-    };
-
-    OP getNand(I arity) const {
-      switch (arity) {
-      case  1: return opNot;
-      case  2: return opNand2;
-      case  3: return opNand3;
-      default: return opNandN;
-      }
+      return isChanged;
     }
 
-    //------------------------------------------------------------------------//
-    // NOR
-    //------------------------------------------------------------------------//
-
-    const OP opNor2 = [this](I out, IV in) {
-      memory[out] = !(memory[in[0]] || memory[in[1]]);
-    };
-
-    const OP opNor3 = [this](I out, IV in) {
-      memory[out] = !(memory[in[0]] || memory[in[1]] || memory[in[2]]);
-    };
-
-    const OP opNorN = [this](I out, IV in) {
-      for (auto i : in) {
-        if (memory[i]) {
-          memory[out] = 0;
-          return;
-        }
+    /// Gets the output values.
+    void getTargets(State &s, BV &values) const {
+      assert(values.size() == outputs.size());
+      for (I i = 0; i < outputs.size(); i++) {
+        values[i] = *value(s, outputs[i]) & 1;
       }
-      memory[out] = 1;
-    };
+    }
 
-    OP getNor(I arity) const {
-      switch (arity) {
-      case  1: return opNot;
-      case  2: return opNor2;
-      case  3: return opNor3;
-      default: return opNorN;
+    /// Gets the output values.
+    void getTargets(State &s, std::uint64_t &values) const {
+      assert(outputs.size() <= 64);
+      values = 0;
+      for (I i = 0; i < outputs.size(); i++) {
+        values |= ((*value(s, outputs[i]) & 1) << i);
       }
     }
 
-    //------------------------------------------------------------------------//
-    // XNOR
-    //------------------------------------------------------------------------//
-
-    const OP opXnor2 = [this](I out, IV in) {
-      memory[out] = memory[in[0]] == memory[in[1]];
-    };
-
-    const OP opXnor3 = [this](I out, IV in) {
-      memory[out] = !(memory[in[0]] ^ memory[in[1]] ^ memory[in[2]]);
-    };
-
-    const OP opXnorN = [this](I out, IV in) {
-      bool result = 1;
-      for (auto i : in) {
-        result ^= memory[i];
-      }
-      memory[out] = result;
-    };
+    /// Gets the output values (nPatterns() patterns).
+    void getTargets(State &s, WV &values) const {
+      assert(values.size() == outputs.size() * blockSize);
+      getTargets(s, values.data());
+    }
 
-    OP getXnor(I arity) const {
-      switch (arity) {
-      case  1: return opNot;
-      case  2: return opXnor2;
-      case  3: return opXnor3;
-      default: return opXnorN;
+    /// Gets the output values (nPatterns() patterns).
+    void getTargets(State &s, W *values) const {
+      for (I i = 0; i < outputs.size(); i++) {
+        std::copy_n(value(s, outputs[i]), blockSize,
+                    values + i * blockSize);
       }
     }
 
-    //------------------------------------------------------------------------//
-    // LATCH
-    //------------------------------------------------------------------------//
-
-    const OP opLatch = [this](I out, IV in) {
-      const bool ena = memory[in[1]];
-      if (ena) {
-        postponed[nPostponed++] = {out, memory[in[0]]};
-      }
+    /// Operation codes.
+    enum Opcode : std::uint32_t {
+      ZERO,
+      ONE,
+      NOP,
+      NOT,
+      AND2,
+      OR2,
+      XOR2,
+      NAND2,
+      NOR2,
+      XNOR2,
+      AND,
+      OR,
+      XOR,
+      NAND,
+      NOR,
+      XNOR,
+      LATCH,
+      DFF,
+      DFFrs
     };
 
-    OP getLatch(I arity) const { return opLatch; }
+    /// Bytecode word.
+    using C  = std::uint32_t;
+    using CV = std::vector<C>;
 
-    //------------------------------------------------------------------------//
-    // DFF
-    //------------------------------------------------------------------------//
+    /// Invalid memory index.
+    static constexpr C NONE = ~C{0};
 
-    const OP opDff = [this](I out, IV in) {
-      // TODO: posedge(clk).
-      const bool clk = memory[in[1]];
-      if (clk) {
-        postponed[nPostponed++] = {out, memory[in[0]]};
-      }
-    };
+    /// Checks whether the operation is a trigger (its output is postponed).
+    static bool isTrigger(C op) {
+      return op == LATCH || op == DFF || op == DFFrs;
+    }
 
-    OP getDff(I arity) const { return opDff; }
-
-    //------------------------------------------------------------------------//
-    // DFFrs
-    //------------------------------------------------------------------------//
-
-    const OP opDffrs = [this](I out, IV in) {
-      // TODO: posedge(clk).
-      const bool clk = memory[in[1]];
-      const bool rst = memory[in[2]];
-      const bool set = memory[in[3]];
-      assert(!(rst && set));
-
-      if (rst) {
-        postponed[nPostponed++] = {out, 0};
-      } else if (set) {
-        postponed[nPostponed++] = {out, 1};
-      } else if (clk) {
-        postponed[nPostponed++] = {out, memory[in[0]]};
-      }
-    };
+    /// Executes the instructions [pc, end) of the program (see
+    /// simulator.cpp).
+    using Kernel = void (*)(State &state, const C *pc, const C *end);
+    /// Executes the compiled program.
+    using Executor = void (*)(Compiled &compiled, State &state);
+
+    /// Evaluates the instruction and returns the next one.
+    template <typename V>
+    static const C *eval(State &state, const C *pc, V *m, V *next);
+
+    /// Executes the instructions over the blocks of type V (V is a word or
+    /// a vector of words).
+    template <typename V>
+    static void execute(State &state, const C *pc, const C *end);
+
+    /// Executes the whole program by the kernel.
+    static void executeAll(Compiled &compiled, State &state);
+
+    /// Executes the instructions affected by the changes of the inputs
+    /// and the trigger outputs (event-driven simulation).
+    static void executeEvents(Compiled &compiled, State &state);
+
+    /// Executes the program level by level (the instructions of a level
+    /// are evaluated in parallel).
+    static void executeLevels(Compiled &compiled, State &state);
+
+    /// Computes the instruction offsets and levels (the inputs and the
+    /// trigger outputs are of level 0).
+    void getLevels(IV &offsets, std::vector<C> &levels) const;
+
+    /// Prepares the event-driven simulation.
+    void initEvents();
+
+    /// Reorders the program by levels and prepares the level-parallel
+    /// simulation.
+    void initLevels(ThreadPool &pool);
+
+    /// Reassigns the memory slots so that the values share the slots
+    /// w/ non-overlapping lifetimes (see compileCompact()).
+    void reuseSlots();
+
+    /// Returns the fastest kernel for the given block size.
+    static Kernel getKernel(I nWords);
+
+    /// Executes the native code (see codegen.cpp).
+    static void executeNative(Compiled &compiled, State &state);
+
+    /// Native code: m - memory, next/post - postponed assignments.
+    using Native = void (*)(W *m, W *next, I *post);
+
+    /// Returns the C++ code of the program (see codegen.cpp).
+    std::string generate() const;
+    /// Returns the structural hash of the program.
+    std::uint64_t hash() const;
+    /// Returns the program signature (the data the native code is
+    /// generated from): the hash key of the cache is checked against it.
+    std::string signature() const;
+    /// Builds (or loads from the disk cache) and installs the native code.
+    /// Returns false if the code cannot be built or loaded.
+    bool loadNative();
+
+    /// Returns the operation code for the gate.
+    static Opcode getOpcode(GateSymbol func, I arity);
+    /// Appends the instruction for the given gate to the program (slots are
+    /// the memory indices of the gates and the external inputs).
+    void emit(const DNet &net,
+              DNet::Index target,
+              const std::vector<C> &slots);
+
+    /// Compiled program for the given net (bytecode). Each instruction is
+    /// stored as follows: opcode, arity, output index, and input indices.
+    CV code;
+    /// Number of the program inputs.
+    I nInputs;
+    /// Number of the values in memory (including the extra ones).
+    I nSlots;
+    /// Program outputs: indices in memory (see below).
+    IV outputs;
 
-    OP getDffrs(I arity) const { return opDffrs; }
+    /// Number of words per value.
+    I blockSize;
+    /// Kernel for the block size.
+    Kernel kernel;
+    /// Execution mode.
+    Executor executor;
+
+    /// Native code (if loaded) and the shared object holding it.
+    Native native;
+    std::shared_ptr<void> library;
+
+    /// State of the event-driven simulation.
+    struct Events final {
+      /// Instruction offsets in the code.
+      IV offsets;
+      /// Instruction levels (the inputs and the triggers are of level 0).
+      std::vector<C> levels;
+      /// Fanout of the memory values (instruction indices in CSR format).
+      IV fanoutBegin;
+      std::vector<C> fanout;
+      /// Inputs and trigger outputs w/ the values of the last pass.
+      IV boundary;
+      WV shadow;
+      /// Instructions scheduled for evaluation (a bucket per level).
+      std::vector<std::vector<C>> wheel;
+      std::vector<std::uint8_t> scheduled;
+      /// Number of the instructions evaluated in the last pass.
+      I nEvaluated = 0;
+      /// Flag indicating that the first (full) pass has been done.
+      bool isInitialized = false;
+    } events;
+
+    /// State of the level-parallel simulation.
+    struct Parallel final {
+      /// Bounds of the levels: instruction indices (the triggers form
+      /// the last level, which is evaluated sequentially).
+      IV levelBegin;
+      /// Instruction offsets in the code (+ the code size).
+      IV offsets;
+      /// Pool for evaluating the levels.
+      ThreadPool *pool = nullptr;
+    } parallel;
+
+    /// Current state.
+    State state;
+
+    /// Positions of the source links that are not ports (the memory index
+    /// of a source is its position): the offsets of the target gates (by
+    /// identifier) in sourceInputs and the positions by the inputs or NONE.
+    eda::utils::IdMap<Gate::Id, C> sourceOffsets;
+    std::vector<C> sourceInputs;
+    /// Memory indices of the gates (by identifier) or NONE.
+    eda::utils::IdMap<Gate::Id, C> gateSlots;
   };
 
-  /// Compiles the given net.
+  /// Compiles the given net (nWords is the number of words per value).
   Compiled compile(const GNet &net,
                    const GNet::LinkList &in,
-                   const GNet::LinkList &out) {
-    return Compiled(net, in, out);
+                   const GNet::LinkList &out,
+                   std::size_t nWords = 1) {
+    return Compiled(net, in, out, nWords);
+  }
+
+  /// Compiles the given net for the event-driven simulation (WIDTH
+  /// patterns per pass): only the gates affected by the changes of the
+  /// inputs and the trigger outputs are evaluated (in level order).
+  Compiled compileEventDriven(const GNet &net,
+                              const GNet::LinkList &in,
+                              const GNet::LinkList &out) {
+    Compiled compiled(net, in, out, 1);
+    compiled.initEvents();
+    return compiled;
+  }
+
+  /// Compiles the given net to native code (WIDTH patterns per pass).
+  /// The shared objects are cached in $UTOPIA_SIM_CACHE (or in
+  /// $XDG_CACHE_HOME/utopia-sim, or in /tmp/utopia-sim-<uid>), which must
+  /// be owned by the user and closed to others; the system compiler is $CXX
+  /// (or c++). If the code cannot be built or loaded, the bytecode
+  /// interpreter is used.
+  Compiled compileNative(const GNet &net,
+                         const GNet::LinkList &in,
+                         const GNet::LinkList &out) {
+    Compiled compiled(net, in, out, 1);
+    compiled.loadNative();
+    return compiled;
+  }
+
+  /// Compiles the given net for the level-parallel simulation: the gates
+  /// of each level are evaluated in parallel by the pool threads (there is
+  /// a barrier between the levels). It pays off for very wide nets.
+  Compiled compileLevelParallel(const GNet &net,
+                                const GNet::LinkList &in,
+                                const GNet::LinkList &out,
+                                std::size_t nWords = 1,
+                                ThreadPool &pool = ThreadPool::get()) {
+    Compiled compiled(net, in, out, nWords);
+    compiled.initLevels(pool);
+    return compiled;
+  }
+
+  /// Compiles the given net w/ the memory slots reused: the lifetimes of
+  /// the values are computed in the program order, and the slots of dead
+  /// values are reassigned to new ones (the inputs, the outputs, and the
+  /// triggers are pinned). For deep nets, the memory size is about the
+  /// maximum number of live values rather than the number of gates.
+  Compiled compileCompact(const GNet &net,
+                          const GNet::LinkList &in,
+                          const GNet::LinkList &out,
+                          std::size_t nWords = 1) {
+    Compiled compiled(net, in, out, nWords);
+    compiled.reuseSlots();
+    return compiled;
   }
 };
 
@@ -0,0 +1,328 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/simulator/stream.h"
+#include "util/logging.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace eda::gate::simulator {
+
+static constexpr std::size_t WIDTH = Simulator::Compiled::WIDTH;
+
+static int getDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+//===----------------------------------------------------------------------===//
+// Reader
+//===----------------------------------------------------------------------===//
+
+VectorReader::VectorReader(const std::string &path,
+                           std::size_t width,
+                           VectorFormat format):
+    _width(width),
+    _format(format),
+    _isOpen(false),
+    _isMalformed(false),
+    _data(nullptr),
+    _size(0),
+    _pos(0) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) == 0) {
+    // An empty file cannot be mapped.
+    _isOpen = (info.st_size == 0);
+
+    if (info.st_size > 0) {
+      void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        madvise(data, info.st_size, MADV_SEQUENTIAL);
+        _data = static_cast<const char*>(data);
+        _size = info.st_size;
+        _isOpen = true;
+      }
+    }
+  }
+
+  close(fd);
+}
+
+VectorReader::~VectorReader() {
+  if (_data != nullptr) {
+    munmap(const_cast<char*>(_data), _size);
+  }
+}
+
+std::size_t VectorReader::read(WV &block, std::size_t nWords) {
+  assert(block.size() == _width * nWords);
+  std::fill(block.begin(), block.end(), 0);
+
+  if (_data == nullptr) {
+    return 0;
+  }
+
+  std::size_t lane = 0;
+  while (lane < nWords * WIDTH) {
+    const bool isRead = (_format == VectorFormat::BINARY)
+        ? readBinary(block, nWords, lane)
+        : readHex(block, nWords, lane);
+
+    if (!isRead) {
+      break;
+    }
+    lane++;
+  }
+
+  return lane;
+}
+
+bool VectorReader::readBinary(WV &block, std::size_t nWords,
+                              std::size_t lane) {
+  const std::size_t nBytes = (_width + 7) / 8;
+  if (_pos + nBytes > _size) {
+    return false;
+  }
+
+  const auto word = lane / WIDTH;
+  const W mask = W{1} << (lane % WIDTH);
+
+  for (std::size_t i = 0; i < nBytes; i++) {
+    for (unsigned byte = static_cast<unsigned char>(_data[_pos + i]); byte;
+         byte &= byte - 1) {
+      const auto bit = 8 * i + __builtin_ctz(byte);
+      if (bit < _width) {
+        block[bit * nWords + word] |= mask;
+      }
+    }
+  }
+
+  _pos += nBytes;
+  return true;
+}
+
+bool VectorReader::readHex(WV &block, std::size_t nWords, std::size_t lane) {
+  // Skip the empty lines and the comments.
+  while (_pos < _size) {
+    const char c = _data[_pos];
+    if (c == '#') {
+      while (_pos < _size && _data[_pos] != '\n') _pos++;
+    } else if (c == '\n' || c == '\r' || c == ' ' || c == '\t') {
+      _pos++;
+    } else {
+      break;
+    }
+  }
+
+  if (_pos == _size) {
+    return false;
+  }
+
+  // The optional prefix.
+  if (_pos + 1 < _size && _data[_pos] == '0'
+      && (_data[_pos + 1] == 'x' || _data[_pos + 1] == 'X')) {
+    _pos += 2;
+  }
+
+  auto end = _pos;
+  while (end < _size && getDigit(_data[end]) >= 0) end++;
+
+  // The number may only be followed by spaces and a comment.
+  auto tail = end;
+  while (tail < _size && (_data[tail] == ' ' || _data[tail] == '\t'
+                                            || _data[tail] == '\r')) tail++;
+
+  if (end == _pos || (tail < _size && _data[tail] != '\n'
+                                   && _data[tail] != '#')) {
+    const auto line = std::count(_data, _data + _pos, '\n') + 1;
+    LOG(ERROR) << "Malformed vector at line " << line << std::endl;
+
+    _isMalformed = true;
+    return false;
+  }
+
+  const auto word = lane / WIDTH;
+  const W mask = W{1} << (lane % WIDTH);
+
+  // The last digit holds the lower bits.
+  for (std::size_t i = 0; i < end - _pos; i++) {
+    for (unsigned digit = getDigit(_data[end - 1 - i]); digit;
+         digit &= digit - 1) {
+      const auto bit = 4 * i + __builtin_ctz(digit);
+      if (bit < _width) {
+        block[bit * nWords + word] |= mask;
+      }
+    }
+  }
+
+  // Skip the rest of the line.
+  _pos = tail;
+  while (_pos < _size && _data[_pos] != '\n') _pos++;
+
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Writer
+//===----------------------------------------------------------------------===//
+
+VectorWriter::VectorWriter(const std::string &path,
+                           std::size_t width,
+                           VectorFormat format):
+    _width(width), _format(format), _error(false) {
+  _fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  _buffer.reserve(BUFFER_SIZE);
+}
+
+VectorWriter::~VectorWriter() {
+  if (_fd >= 0) {
+    flush();
+    close(_fd);
+  }
+}
+
+void VectorWriter::write(const WV &block, std::size_t nWords,
+                         std::size_t nVectors) {
+  static constexpr char digits[] = "0123456789abcdef";
+
+  assert(block.size() == _width * nWords);
+  assert(nVectors <= nWords * WIDTH);
+
+  const std::size_t nChars = (_format == VectorFormat::BINARY)
+      ? (_width + 7) / 8
+      : (_width + 3) / 4 + 1;
+
+  for (std::size_t lane = 0; lane < nVectors; lane++) {
+    if (_buffer.size() + nChars > BUFFER_SIZE) {
+      flush();
+    }
+
+    const auto word = lane / WIDTH;
+    const auto shift = lane % WIDTH;
+
+    auto bit = [&](std::size_t i) -> unsigned {
+      return i < _width ? (block[i * nWords + word] >> shift) & 1 : 0;
+    };
+
+    if (_format == VectorFormat::BINARY) {
+      for (std::size_t i = 0; i < nChars; i++) {
+        unsigned byte = 0;
+        for (std::size_t j = 0; j < 8; j++) {
+          byte |= bit(8 * i + j) << j;
+        }
+        _buffer.push_back(static_cast<char>(byte));
+      }
+    } else {
+      // The first digit holds the upper bits.
+      for (std::size_t i = nChars - 1; i > 0; i--) {
+        const auto k = 4 * (i - 1);
+        _buffer.push_back(digits[bit(k) | (bit(k + 1) << 1)
+                                        | (bit(k + 2) << 2)
+                                        | (bit(k + 3) << 3)]);
+      }
+      _buffer.push_back('\n');
+    }
+  }
+}
+
+bool VectorWriter::flush() {
+  if (_fd < 0) {
+    _buffer.clear();
+    return false;
+  }
+
+  std::size_t written = 0;
+  while (written < _buffer.size()) {
+    const auto n = ::write(_fd, _buffer.data() + written,
+                           _buffer.size() - written);
+    if (n <= 0) {
+      _error = true;
+      break;
+    }
+    written += n;
+  }
+
+  _buffer.clear();
+  return !_error;
+}
+
+//===----------------------------------------------------------------------===//
+// Simulation
+//===----------------------------------------------------------------------===//
+
+StreamStats simulate(Simulator::Compiled &compiled,
+                     VectorReader &stimulus,
+                     VectorWriter *response,
+                     VectorReader *golden) {
+  using W = Simulator::Compiled::W;
+  using WV = Simulator::Compiled::WV;
+
+  const auto nWords = compiled.nWords();
+  const auto nInputs = compiled.nSources();
+  const auto nOutputs = compiled.nTargets();
+
+  assert(stimulus.width() == nInputs);
+  assert(!response || response->width() == nOutputs);
+  assert(!golden || golden->width() == nOutputs);
+
+  WV in(nInputs * nWords), out(nOutputs * nWords), expected(out.size());
+
+  StreamStats stats;
+  while (const auto nVectors = stimulus.read(in, nWords)) {
+    compiled.simulate(out, in);
+
+    if (response) {
+      response->write(out, nWords, nVectors);
+    }
+
+    if (golden) {
+      // The missing golden vectors are considered to be zeros.
+      golden->read(expected, nWords);
+
+      for (std::size_t j = 0; j < nWords && j * WIDTH < nVectors; j++) {
+        const auto nValid = std::min(WIDTH, nVectors - j * WIDTH);
+        const W valid = (nValid == WIDTH) ? ~W{0} : (W{1} << nValid) - 1;
+
+        W diff = 0;
+        for (std::size_t i = 0; i < nOutputs; i++) {
+          diff |= out[i * nWords + j] ^ expected[i * nWords + j];
+        }
+        diff &= valid;
+
+        if (diff && !stats.nMismatches) {
+          stats.firstMismatch = stats.nVectors + j * WIDTH
+                              + __builtin_ctzll(diff);
+        }
+        stats.nMismatches += __builtin_popcountll(diff);
+      }
+    }
+
+    stats.nVectors += nVectors;
+  }
+
+  if (response) {
+    response->flush();
+  }
+
+  return stats;
+}
+
+} // namespace eda::gate::simulator
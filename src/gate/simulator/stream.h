@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/simulator/simulator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace eda::gate::simulator {
+
+/// Format of the test vector files (the i-th bit of a vector is the value
+/// of the i-th input/output).
+enum class VectorFormat {
+  /// Packed vectors: (width + 7) / 8 bytes per vector (LSB first).
+  BINARY,
+  /// Hexadecimal numbers w/ an optional 0x prefix: a vector per line
+  /// (empty lines and the lines starting w/ '#' are skipped; a number may
+  /// be followed by a comment).
+  HEX
+};
+
+/**
+ * \brief Reads test vectors from a memory-mapped file in bit-parallel
+ *        blocks.
+ */
+class VectorReader final {
+public:
+  using W  = Simulator::Compiled::W;
+  using WV = Simulator::Compiled::WV;
+
+  VectorReader(const std::string &path,
+               std::size_t width,
+               VectorFormat format);
+  ~VectorReader();
+
+  VectorReader(const VectorReader &) = delete;
+  VectorReader &operator =(const VectorReader &) = delete;
+
+  /// Checks whether the file has been opened (and mapped).
+  bool isOpen() const { return _isOpen; }
+
+  /// Checks whether a malformed vector has been met (the reading stops
+  /// there; the diagnostic is logged).
+  bool isMalformed() const { return _isMalformed; }
+
+  /// Returns the number of bits per vector.
+  std::size_t width() const { return _width; }
+
+  /// Reads up to nWords * WIDTH vectors into the block laid out as in the
+  /// WV simulate() (nWords consecutive words per bit). Returns the number
+  /// of the vectors read (0 at the end of the file).
+  std::size_t read(WV &block, std::size_t nWords);
+
+private:
+  /// Reads a vector into the given lane of the block.
+  bool readBinary(WV &block, std::size_t nWords, std::size_t lane);
+  bool readHex(WV &block, std::size_t nWords, std::size_t lane);
+
+  const std::size_t _width;
+  const VectorFormat _format;
+
+  /// Mapped file and the current position.
+  bool _isOpen;
+  bool _isMalformed;
+  const char *_data;
+  std::size_t _size;
+  std::size_t _pos;
+};
+
+/**
+ * \brief Writes test vectors from bit-parallel blocks to a file through
+ *        a buffer.
+ */
+class VectorWriter final {
+public:
+  using W  = Simulator::Compiled::W;
+  using WV = Simulator::Compiled::WV;
+
+  /// Size of the buffer (in bytes).
+  static constexpr std::size_t BUFFER_SIZE = 1 << 20;
+
+  VectorWriter(const std::string &path,
+               std::size_t width,
+               VectorFormat format);
+  ~VectorWriter();
+
+  VectorWriter(const VectorWriter &) = delete;
+  VectorWriter &operator =(const VectorWriter &) = delete;
+
+  /// Checks whether the file has been opened and written w/o errors.
+  bool isOpen() const { return _fd >= 0 && !_error; }
+
+  /// Returns the number of bits per vector.
+  std::size_t width() const { return _width; }
+
+  /// Writes the first nVectors vectors of the block laid out as in the WV
+  /// simulate() (nWords consecutive words per bit).
+  void write(const WV &block, std::size_t nWords, std::size_t nVectors);
+
+  /// Writes the buffered data to the file.
+  bool flush();
+
+private:
+  const std::size_t _width;
+  const VectorFormat _format;
+
+  int _fd;
+  bool _error;
+
+  std::vector<char> _buffer;
+};
+
+/// Statistics of a stream simulation.
+struct StreamStats final {
+  /// Number of the simulated vectors.
+  std::size_t nVectors = 0;
+  /// Number of the vectors whose responses differ from the golden ones.
+  std::size_t nMismatches = 0;
+  /// Index of the first mismatching vector (if any).
+  std::size_t firstMismatch = 0;
+};
+
+/// Simulates the compiled net over the stimulus vectors in blocks of
+/// nPatterns() vectors (a block per pass). The responses are written to
+/// the given writer and compared w/ the golden ones (if not null).
+StreamStats simulate(Simulator::Compiled &compiled,
+                     VectorReader &stimulus,
+                     VectorWriter *response,
+                     VectorReader *golden = nullptr);
+
+} // namespace eda::gate::simulator
@@ -0,0 +1,318 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/simulator/wave.h"
+
+#include <zlib.h>
+
+#include <cstring>
+
+namespace eda::gate::simulator {
+
+using ThreadPool = eda::utils::ThreadPool;
+
+/// File signature.
+static constexpr char MAGIC[] = "UTWAVE";
+/// Version of the format.
+static constexpr std::uint16_t VERSION = 2;
+/// Compression strategy (see WaveWriter::write()).
+static constexpr int STRATEGY = Z_RLE;
+
+template <typename T>
+static void put(std::string &out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool get(std::istream &in, T &value) {
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value),
+                                   sizeof(T)));
+}
+
+//===----------------------------------------------------------------------===//
+// Writer
+//===----------------------------------------------------------------------===//
+
+WaveWriter::WaveWriter(const std::string &path,
+                       const Compiled &compiled,
+                       const std::vector<Signal> &signals):
+    _compiled(compiled),
+    _nWords(compiled.nWords()),
+    _rowSize(std::max<std::size_t>(signals.size() * compiled.nWords(), 1)),
+    _blockCycles(std::max<std::size_t>(BLOCK_SIZE / (_rowSize * sizeof(W)),
+                                       1)),
+    _block(_blockCycles * _rowSize),
+    _spare(_block.size()),
+    _nCycles(0),
+    _last(_rowSize, 0),
+    _out(path, std::ios::binary),
+    _isOpen(_out.good()) {
+  std::string header(MAGIC, sizeof(MAGIC) - 1);
+  put<std::uint16_t>(header, VERSION);
+  put<std::uint32_t>(header, signals.size());
+  put<std::uint32_t>(header, _nWords);
+
+  for (const auto &[name, link] : signals) {
+    put<std::uint32_t>(header, name.size());
+    header.append(name);
+    _indices.push_back(compiled.getIndex(link));
+  }
+
+  _out.write(header.data(), header.size());
+  _isOpen = _out.good();
+}
+
+WaveWriter::~WaveWriter() {
+  flush();
+}
+
+bool WaveWriter::flush() {
+  if (_nCycles != 0) {
+    submit();
+  }
+  wait();
+
+  return isOpen();
+}
+
+void WaveWriter::submit() {
+  // The previous block should be written before the next one.
+  wait();
+
+  std::swap(_block, _spare);
+  const auto nCycles = _nCycles;
+  _nCycles = 0;
+
+  // A pool worker does not wait for the other workers (see ThreadPool).
+  if (ThreadPool::isWorker()) {
+    write(_spare, nCycles);
+  } else {
+    _pending = ThreadPool::get().submit([this, nCycles]() {
+      write(_spare, nCycles);
+    });
+  }
+}
+
+void WaveWriter::wait() {
+  if (_pending.valid()) {
+    _pending.get();
+  }
+}
+
+void WaveWriter::write(WV &block, std::size_t nCycles) {
+  // Nothing is written after a failure.
+  if (!_isOpen) {
+    return;
+  }
+
+  // Each row is replaced w/ the XOR w/ the previous one (zero words are
+  // squeezed by the compressor).
+  const std::size_t size = nCycles * _rowSize;
+  const WV last(block.begin() + (size - _rowSize), block.begin() + size);
+
+  for (std::size_t j = size; j-- > _rowSize;) {
+    block[j] ^= block[j - _rowSize];
+  }
+  for (std::size_t i = 0; i < _rowSize; i++) {
+    block[i] ^= _last[i];
+  }
+  _last = last;
+
+  const auto *data = reinterpret_cast<const Bytef*>(block.data());
+  const uLong rawSize = size * sizeof(W);
+
+  _packed.resize(compressBound(rawSize));
+
+  // Run-length encoding + Huffman coding (zero words are frequent, while
+  // the changes are mostly random, so string matching does not pay off).
+  z_stream stream{};
+  if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, 15, 8, STRATEGY)
+        != Z_OK) {
+    _isOpen = false;
+    return;
+  }
+
+  stream.next_in = const_cast<Bytef*>(data);
+  stream.avail_in = rawSize;
+  stream.next_out = reinterpret_cast<Bytef*>(_packed.data());
+  stream.avail_out = _packed.size();
+
+  const bool isPacked = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+  const uLong packedSize = stream.total_out;
+  deflateEnd(&stream);
+
+  if (!isPacked) {
+    _isOpen = false;
+    return;
+  }
+
+  std::string header;
+  put<std::uint32_t>(header, nCycles);
+  put<std::uint32_t>(header, packedSize);
+
+  _out.write(header.data(), header.size());
+  _out.write(_packed.data(), packedSize);
+  _out.flush();
+
+  _isOpen = _out.good();
+}
+
+//===----------------------------------------------------------------------===//
+// Reader
+//===----------------------------------------------------------------------===//
+
+WaveReader::WaveReader(const std::string &path):
+    _isOpen(false),
+    _nWords(0),
+    _in(path, std::ios::binary),
+    _nCycles(0),
+    _cycle(0) {
+  char magic[sizeof(MAGIC) - 1];
+  std::uint16_t version;
+  std::uint32_t nSignals, nWords;
+
+  if (!_in.read(magic, sizeof(magic))
+      || std::memcmp(magic, MAGIC, sizeof(magic)) != 0
+      || !get(_in, version) || version != VERSION
+      || !get(_in, nSignals) || !get(_in, nWords)) {
+    return;
+  }
+
+  for (std::uint32_t i = 0; i < nSignals; i++) {
+    std::uint32_t length;
+    if (!get(_in, length)) {
+      return;
+    }
+
+    std::string name(length, '\0');
+    if (!_in.read(name.data(), length)) {
+      return;
+    }
+    _names.push_back(name);
+  }
+
+  _nWords = nWords;
+  _values.assign(nSignals * nWords, 0);
+  _isOpen = true;
+}
+
+bool WaveReader::readBlock() {
+  std::uint32_t nCycles, packedSize;
+  if (!get(_in, nCycles) || !get(_in, packedSize) || nCycles == 0) {
+    return false;
+  }
+
+  _packed.resize(packedSize);
+  if (!_in.read(_packed.data(), packedSize)) {
+    return false;
+  }
+
+  const std::size_t rowSize = std::max<std::size_t>(_values.size(), 1);
+  const uLong rawSize = nCycles * rowSize * sizeof(W);
+
+  uLongf size = rawSize;
+  _block.resize(nCycles * rowSize);
+
+  const auto status = uncompress(reinterpret_cast<Bytef*>(_block.data()),
+                                 &size,
+                                 reinterpret_cast<const Bytef*>(_packed.data()),
+                                 packedSize);
+
+  _nCycles = nCycles;
+  _cycle = 0;
+  return status == Z_OK && size == rawSize;
+}
+
+const WaveReader::WV *WaveReader::next() {
+  if (!_isOpen || (_cycle == _nCycles && !readBlock())) {
+    return nullptr;
+  }
+
+  const std::size_t rowSize = std::max<std::size_t>(_values.size(), 1);
+  const W *row = _block.data() + _cycle * rowSize;
+  for (std::size_t i = 0; i < _values.size(); i++) {
+    _values[i] ^= row[i];
+  }
+  _cycle++;
+
+  return &_values;
+}
+
+//===----------------------------------------------------------------------===//
+// VCD
+//===----------------------------------------------------------------------===//
+
+/// Returns the VCD identifier of the i-th signal.
+static std::string getVcdId(std::size_t i) {
+  std::string id;
+  do {
+    id.push_back(static_cast<char>('!' + i % 94));
+    i /= 94;
+  } while (i != 0);
+  return id;
+}
+
+bool exportVcd(const std::string &wavePath,
+               const std::string &vcdPath,
+               std::size_t pattern) {
+  using W = WaveReader::W;
+
+  WaveReader reader(wavePath);
+  if (!reader.isOpen()) {
+    return false;
+  }
+
+  const auto width = Simulator::Compiled::WIDTH;
+  const auto nWords = reader.nWords();
+  const auto &names = reader.names();
+
+  if (pattern >= nWords * width) {
+    return false;
+  }
+
+  const auto word = pattern / width;
+  const auto shift = pattern % width;
+
+  std::ofstream out(vcdPath);
+  out << "$timescale 1ns $end\n"
+      << "$scope module top $end\n";
+  for (std::size_t i = 0; i < names.size(); i++) {
+    out << "$var wire 1 " << getVcdId(i) << " " << names[i] << " $end\n";
+  }
+  out << "$upscope $end\n"
+      << "$enddefinitions $end\n";
+
+  // The initial values are unknown (the first cycle dumps all of them).
+  std::vector<int> last(names.size(), -1);
+
+  std::string changes;
+  std::size_t cycle = 0;
+  for (const auto *values = reader.next(); values; values = reader.next()) {
+    changes.clear();
+
+    for (std::size_t i = 0; i < names.size(); i++) {
+      const int bit = ((*values)[i * nWords + word] >> shift) & W{1};
+      if (bit != last[i]) {
+        changes.push_back(bit ? '1' : '0');
+        changes.append(getVcdId(i));
+        changes.push_back('\n');
+        last[i] = bit;
+      }
+    }
+
+    if (!changes.empty()) {
+      out << "#" << cycle << "\n" << changes;
+    }
+    cycle++;
+  }
+  out << "#" << cycle << "\n";
+
+  return out.good();
+}
+
+} // namespace eda::gate::simulator
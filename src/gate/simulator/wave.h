@@ -0,0 +1,170 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/simulator/simulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace eda::gate::simulator {
+
+/*
+ * Waveform file format (little-endian):
+ *
+ *   header: "UTWAVE" VERSION (2 bytes), nSignals (u32), nWords (u32),
+ *           nSignals names (u32 length + chars);
+ *   blocks: nCycles (u32), packedSize (u32), zlib-compressed rows.
+ *
+ * A row describes a cycle: nSignals * nWords words (signal * nWords + word),
+ * each being the XOR w/ the same word of the previous cycle. The initial
+ * values are zeros.
+ */
+
+/**
+ * \brief Records the values of the selected signals over the cycles into
+ *        a compact binary waveform file.
+ *
+ * Sampling only copies the values to the current block; full blocks are
+ * encoded, compressed, and written by the thread pool (in the background).
+ */
+class WaveWriter final {
+public:
+  using Compiled = Simulator::Compiled;
+  using Link = eda::gate::model::Gate::Link;
+  using Signal = std::pair<std::string, Link>;
+  using W = Compiled::W;
+  using WV = Compiled::WV;
+
+  /// Size of the uncompressed block (in bytes).
+  static constexpr std::size_t BLOCK_SIZE = 1 << 20;
+
+  /// Creates the waveform for the given signals (named source links or
+  /// gates, e.g., outputs or triggers) of the compiled net.
+  WaveWriter(const std::string &path,
+             const Compiled &compiled,
+             const std::vector<Signal> &signals);
+  ~WaveWriter();
+
+  WaveWriter(const WaveWriter &) = delete;
+  WaveWriter &operator =(const WaveWriter &) = delete;
+
+  /// Checks whether the file has been opened and written w/o errors.
+  bool isOpen() const { return _isOpen; }
+
+  /// Records the current values of the signals (called once per cycle,
+  /// e.g., from the run() response).
+  void sample() {
+    const W *memory = _compiled.getValue(0);
+    W *row = _block.data() + _nCycles * _rowSize;
+
+    if (_nWords == 1) {
+      for (std::size_t i = 0; i < _indices.size(); i++) {
+        row[i] = memory[_indices[i]];
+      }
+    } else {
+      for (std::size_t i = 0; i < _indices.size(); i++, row += _nWords) {
+        std::copy_n(memory + _indices[i] * _nWords, _nWords, row);
+      }
+    }
+
+    if (++_nCycles == _blockCycles) {
+      submit();
+    }
+  }
+
+  /// Writes the buffered cycles to the file.
+  bool flush();
+
+private:
+  /// Passes the current block to the background writer.
+  void submit();
+  /// Waits for the background writer.
+  void wait();
+  /// Encodes, compresses, and writes the block (in the background).
+  void write(WV &block, std::size_t nCycles);
+
+  const Compiled &_compiled;
+  const std::size_t _nWords;
+
+  /// Memory indices of the signals.
+  std::vector<std::size_t> _indices;
+
+  /// Number of words per cycle and number of cycles per block.
+  const std::size_t _rowSize;
+  const std::size_t _blockCycles;
+
+  /// Current block (being filled) and the block being written.
+  WV _block;
+  WV _spare;
+  std::size_t _nCycles;
+  std::future<void> _pending;
+
+  /// Values of the last written cycle.
+  WV _last;
+
+  std::ofstream _out;
+  std::string _packed;
+  std::atomic<bool> _isOpen;
+};
+
+/**
+ * \brief Reads the values of the signals from a waveform file.
+ */
+class WaveReader final {
+public:
+  using W = Simulator::Compiled::W;
+  using WV = Simulator::Compiled::WV;
+
+  explicit WaveReader(const std::string &path);
+
+  /// Checks whether the file has been opened and the header is valid.
+  bool isOpen() const { return _isOpen; }
+
+  /// Returns the signal names.
+  const std::vector<std::string> &names() const { return _names; }
+  /// Returns the number of words per value.
+  std::size_t nWords() const { return _nWords; }
+
+  /// Returns the values of the next cycle (nWords() words per signal) or
+  /// nullptr at the end of the file.
+  const WV *next();
+
+private:
+  bool readBlock();
+
+  bool _isOpen;
+  std::vector<std::string> _names;
+  std::size_t _nWords;
+
+  WV _values;
+
+  std::ifstream _in;
+  std::string _packed;
+
+  /// Current block: the rows and the number of the rows read.
+  WV _block;
+  std::size_t _nCycles;
+  std::size_t _cycle;
+};
+
+/// Exports the waveform to the VCD format: the given pattern (of nWords()
+/// * WIDTH ones) is taken; a cycle is a time unit.
+bool exportVcd(const std::string &wavePath,
+               const std::string &vcdPath,
+               std::size_t pattern = 0);
+
+} // namespace eda::gate::simulator
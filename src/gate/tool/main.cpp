@@ -17,10 +17,17 @@ void print_table(eda::gate::model::GNet &net, Gate::SignalList &inputs,Gate::Id
 
     auto compiled = simulator.compile(net, in, out);
 
-    std::uint64_t OUT;
-    for (std::uint64_t i = 0; i < std::pow(2,net.nSourceLinks()); i++) {
-        compiled.simulate(OUT, i);
-        std::cout << std::hex << i << " " << OUT << "\n";
+    using Compiled = eda::gate::simulator::Simulator::Compiled;
+    Compiled::WV IN(in.size());
+    Compiled::WV OUT(out.size());
+    const std::uint64_t N = std::pow(2,net.nSourceLinks());
+    // 64 rows of the table are evaluated per pass.
+    for (std::uint64_t base = 0; base < N; base += Compiled::WIDTH) {
+        Compiled::getPatterns(IN, base);
+        compiled.simulate(OUT, IN);
+        for (std::uint64_t i = base; i < N && i < base + Compiled::WIDTH; i++) {
+            std::cout << std::hex << i << " " << ((OUT[0] >> (i - base)) & 1) << "\n";
+        }
     }
 }
 int main(){
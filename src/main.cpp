@@ -14,6 +14,7 @@
 #include "options.h"
 #include "rtl/compiler/compiler.h"
 #include "rtl/library/flibrary.h"
+#include "rtl/model/context.h"
 #include "rtl/model/net.h"
 #include "rtl/parser/ril/parser.h"
 #include "util/string.h"
@@ -44,6 +45,7 @@ struct RtlContext {
   using PreMapper = eda::gate::premapper::PreMapper;
   using AigMapper = eda::gate::premapper::AigMapper;
   using Checker = eda::gate::debugger::Checker;
+  using Design = eda::rtl::model::DesignContext;
 
   RtlContext(const std::string &file, const RtlOptions &options):
     file(file), options(options) {}
@@ -51,6 +53,9 @@ struct RtlContext {
   const std::string file;
   const RtlOptions &options;
 
+  // Owns the nodes of the design (must outlive the nets).
+  Design design;
+
   std::shared_ptr<VNet> vnet;
   std::shared_ptr<GNet> gnet0;
   std::shared_ptr<GNet> gnet1;
@@ -167,6 +172,8 @@ bool check(RtlContext &context) {
 }
 
 int rtlMain(RtlContext &context) {
+  RtlContext::Design::Scope scope(context.design);
+
   if (!parse(context))   { return -1; }
   if (!compile(context)) { return -1; }
   if (!premap(context))  { return -1; }
@@ -28,6 +28,8 @@ namespace eda::rtl::compiler {
 std::unique_ptr<GNet> Compiler::compile(const Net &net) {
   // Create a new gate-level net.
   auto gnet = std::make_unique<GNet>();
+  // The boundary is computed once (after all the gates are synthesized).
+  gnet->beginBatch();
 
   // Initialize correspondence between vnodes and gates.
   _outputs.clear();
@@ -68,6 +70,7 @@ std::unique_ptr<GNet> Compiler::compile(const Net &net) {
     synthReg(vnode, *gnet);
   }
 
+  gnet->finalize();
   return gnet;
 }
 
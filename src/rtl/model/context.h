@@ -0,0 +1,21 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "base/model/context.h"
+#include "gate/model/gate.h"
+#include "rtl/model/vnode.h"
+
+namespace eda::rtl::model {
+
+/// Design context owning the V-nodes and the gates of a design.
+using DesignContext = eda::base::model::DesignContext<
+    eda::gate::model::GateBase, VNodeBase>;
+
+} // namespace eda::rtl::model
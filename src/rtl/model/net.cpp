@@ -185,7 +185,7 @@ VNode *Net::createMux(const Variable &output, const VNode::List &defines) {
 void Net::sortTopologically() {
   assert(!_isCreated);
 
-  auto vnodeIds = eda::utils::graph::topologicalSort<Net>(*this);
+  auto vnodeIds = eda::utils::graph::topologicalSort<Net, FanoutList>(*this);
   for (size_t i = 0; i < vnodeIds.size(); i++) {
     auto vnodeId = vnodeIds[i];
     _vnodes[i] = VNode::get(vnodeId);
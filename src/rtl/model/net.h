@@ -31,6 +31,7 @@ public:
   using VNodeIdSet  = std::unordered_set<VNodeId>;
   using Link        = VNode::Link;
   using LinkList    = VNode::LinkList;
+  using FanoutList  = VNode::FanoutList;
   using Signal      = VNode::Signal;
   using SignalList  = VNode::SignalList;
 
@@ -157,7 +158,7 @@ public:
   }
 
   /// Returns the outgoing edges of the node.
-  const LinkList &getOutEdges(VNodeId gid) const {
+  FanoutList getOutEdges(VNodeId gid) const {
     return VNode::get(gid)->links();
   }
 
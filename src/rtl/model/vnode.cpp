@@ -20,7 +20,7 @@ static std::ostream &operator <<(std::ostream &out, const std::vector<bool> &val
   return out;
 }
 
-static std::ostream &operator <<(std::ostream &out, const VNode::SignalList &signals) {
+static std::ostream &operator <<(std::ostream &out, const VNode::InputList &signals) {
   bool separator = false;
   for (const auto &signal : signals) {
     const auto *vnode = VNode::get(signal.node());
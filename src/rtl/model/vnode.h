@@ -93,7 +93,9 @@ private:
       _signals(signals),
       _value(value),
       _pnode(nullptr) {
-    assert(std::find(inputs.begin(), inputs.end(), VNode::INVALID) == inputs.end());
+    assert(std::none_of(inputs.begin(), inputs.end(), [](const Signal &input) {
+      return input.node() == VNode::INVALID;
+    }));
   }
 
   VNode(Id id,
@@ -109,12 +111,15 @@ private:
       _signals(signals),
       _value(value),
       _pnode(nullptr) {
-    assert(std::find(inputs.begin(), inputs.end(), VNode::INVALID) == inputs.end());
+    assert(std::none_of(inputs.begin(), inputs.end(), [](const Signal &input) {
+      return input.node() == VNode::INVALID;
+    }));
   }
 
   VNode *duplicate(const std::string &newName) {
     Variable var(newName, _var.kind(), _var.bind(), _var.type());
-    return new VNode(_kind, var, _signals, _func, _inputs, _value);
+    const SignalList inputs(this->inputs().begin(), this->inputs().end());
+    return new VNode(_kind, var, _signals, _func, inputs, _value);
   }
 
   void replaceWith(Kind kind,
@@ -123,9 +128,23 @@ private:
                    FuncSymbol func,
                    const SignalList &inputs,
                    const std::vector<bool> &value) {
+    // Detach the node from its drivers (the new node is attached anew) and
+    // keep its fanout (the readers refer to the node by the identifier).
+    // V-nodes are not structurally hashed, so there is nothing to unhash.
+    removeLinks();
+    auto links = _links;
+
     Id oldId = _id;
     this->~VNode();
     new (this) VNode(oldId, kind, var, signals, func, inputs, value);
+
+    // Self-loops (if any) have been linked to the fresh fanout.
+    for (const auto &link : _links) {
+      assert(link.target == _id);
+      slots()[link.input] = links.size();
+      links.push_back(link);
+    }
+    _links = links;
   }
 
   void setPNode(const PNode *pnode) {
@@ -145,3 +164,12 @@ private:
 std::ostream& operator <<(std::ostream &out, const VNode &vnode);
 
 } // namespace eda::rtl::model
+
+namespace eda::base::model {
+
+template <>
+struct NodeType<eda::rtl::model::FuncSymbol> {
+  using Type = eda::rtl::model::VNode;
+};
+
+} // namespace eda::base::model
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace eda::utils {
+
+/**
+ * \brief Implements a bump-pointer (arena) allocator.
+ *
+ * Memory is taken from large blocks; the objects are placed contiguously
+ * and cannot be freed one by one: all the blocks are released at once.
+ * Destructors of the allocated objects are not called by the arena.
+ */
+class Arena final {
+public:
+  /// Default size of a block (bytes).
+  static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+  explicit Arena(std::size_t blockSize = BLOCK_SIZE):
+      _blockSize(blockSize), _ptr(nullptr), _end(nullptr),
+      _used(0), _reserved(0) {}
+
+  Arena(const Arena &) = delete;
+  Arena &operator =(const Arena &) = delete;
+
+  ~Arena() {
+    release();
+  }
+
+  /// Allocates a memory chunk of the given size and alignment.
+  void *allocate(std::size_t size,
+                 std::size_t align = alignof(std::max_align_t)) {
+    assert(align != 0 && (align & (align - 1)) == 0);
+
+    const auto required = size + align - 1;
+    _used += size;
+
+    // Large chunks are allocated in separate blocks.
+    if (required > _blockSize / 4) {
+      return alignUp(newBlock(required), align);
+    }
+
+    auto *ptr = alignUp(_ptr, align);
+    if (_ptr == nullptr || ptr + size > _end) {
+      _ptr = newBlock(_blockSize);
+      _end = _ptr + _blockSize;
+      ptr = alignUp(_ptr, align);
+    }
+
+    _ptr = ptr + size;
+    return ptr;
+  }
+
+  /// Releases all the memory.
+  void release() {
+    for (auto *block : _blocks) {
+      ::operator delete(block);
+    }
+
+    _blocks.clear();
+    _ptr = _end = nullptr;
+    _used = _reserved = 0;
+  }
+
+  /// Returns the number of bytes allocated by the clients.
+  std::size_t used() const { return _used; }
+  /// Returns the number of bytes taken from the heap.
+  std::size_t reserved() const { return _reserved; }
+  /// Returns the number of blocks.
+  std::size_t nBlocks() const { return _blocks.size(); }
+
+private:
+  static char *alignUp(char *ptr, std::size_t align) {
+    const auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+    return reinterpret_cast<char*>((addr + align - 1) & ~(align - 1));
+  }
+
+  /// Allocates a new block of the given size.
+  char *newBlock(std::size_t size) {
+    auto *block = static_cast<char*>(::operator new(size));
+    _blocks.push_back(block);
+    _reserved += size;
+    return block;
+  }
+
+  const std::size_t _blockSize;
+
+  char *_ptr;
+  char *_end;
+
+  std::size_t _used;
+  std::size_t _reserved;
+
+  std::vector<char*> _blocks;
+};
+
+} // namespace eda::utils
@@ -8,8 +8,14 @@
 
 #pragma once
 
+#include "util/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <functional>
+#include <mutex>
 #include <stack>
 #include <unordered_set>
 #include <vector>
@@ -97,6 +103,85 @@ std::vector<typename G::V> topologicalSort(const G &graph) {
   return sortedNodes;
 }
 
+/// Splits the nodes of the directed graph into levels (feedbacks are
+/// ignored): the sources are at level 0; any other node is at level 1 +
+/// the maximum level of its predecessors. The nodes are required to be
+/// dense indices (V < nNodes()). The levels are built by Kahn's algorithm;
+/// if the pool is given, each level is processed in parallel w/ atomic
+/// in-degree counters. The nodes of each level are sorted.
+template <typename G, typename OutEdgeContainer = std::vector<typename G::E>>
+std::vector<std::vector<typename G::V>> levelize(const G &graph,
+                                                 ThreadPool *pool = nullptr) {
+  using V = typename G::V;
+
+  // Number of the nodes/edges processed by a task.
+  constexpr std::size_t grain = 1024;
+
+  const std::size_t n = graph.nNodes();
+  std::vector<std::atomic<uint32_t>> inDegrees(n);
+
+  auto forEach = [pool](std::size_t size,
+                        const std::function<void(std::size_t,
+                                                 std::size_t)> &body) {
+    if (pool != nullptr) {
+      pool->parallelFor(size, grain, body);
+    } else if (size > 0) {
+      body(0, size);
+    }
+  };
+
+  // Count the incoming edges.
+  forEach(n, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t v = begin; v < end; v++) {
+      const OutEdgeContainer &out = graph.getOutEdges(static_cast<V>(v));
+      for (auto e : out) {
+        if (graph.hasEdge(e) && graph.hasNode(graph.leadsTo(e))) {
+          inDegrees[graph.leadsTo(e)].fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    }
+  });
+
+  std::vector<std::vector<V>> levels;
+
+  const auto &sources = graph.getSources();
+  std::vector<V> current(sources.begin(), sources.end());
+  std::sort(current.begin(), current.end());
+
+  std::mutex mutex;
+  while (!current.empty()) {
+    std::vector<V> next;
+
+    // The last predecessor to be processed puts the node to the next level.
+    forEach(current.size(), [&](std::size_t begin, std::size_t end) {
+      std::vector<V> local;
+      for (std::size_t i = begin; i < end; i++) {
+        const OutEdgeContainer &out = graph.getOutEdges(current[i]);
+        for (auto e : out) {
+          if (!graph.hasEdge(e) || !graph.hasNode(graph.leadsTo(e))) {
+            continue;
+          }
+
+          const auto v = graph.leadsTo(e);
+          if (inDegrees[v].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            local.push_back(v);
+          }
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      next.insert(next.end(), local.begin(), local.end());
+    });
+
+    std::sort(next.begin(), next.end());
+
+    levels.push_back(std::move(current));
+    current = std::move(next);
+  }
+
+  return levels;
+}
+
 /// Traverses the graph in topological order and handles the nodes.
 template <typename G, typename OutEdgeContainer = std::vector<typename G::E>>
 void traverseTopologicalOrder(const G &graph,
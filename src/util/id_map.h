@@ -0,0 +1,227 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace eda::utils {
+
+/**
+ * \brief Implements a map from integer identifiers to values.
+ *
+ * While the identifiers are compact (the span of the identifiers does not
+ * exceed DENSITY * size + SLACK), the values are stored in a dense array
+ * indexed by (identifier - base); otherwise, the map falls back to a hash
+ * table (and stays in this form until it is cleared).
+ */
+template <typename K, typename T>
+class IdMap final {
+  static_assert(std::is_unsigned_v<K>);
+  static_assert(std::is_default_constructible_v<T>);
+  static_assert(!std::is_same_v<T, bool>, "Values must be addressable");
+
+public:
+  /// Maximum ratio of the dense array span to the number of entries.
+  static constexpr std::size_t DENSITY = 4;
+  /// Dense array span allowed regardless of the number of entries.
+  static constexpr std::size_t SLACK = 1024;
+
+  IdMap(): _base(0), _front(0), _size(0), _isDense(true) {}
+
+  //===--------------------------------------------------------------------===//
+  // Access
+  //===--------------------------------------------------------------------===//
+
+  std::size_t size() const { return _size; }
+  bool empty()       const { return _size == 0; }
+  bool isDense()     const { return _isDense; }
+
+  /// Returns the pointer to the value or nullptr.
+  const T *find(K id) const {
+    if (_isDense) {
+      const std::size_t i = static_cast<K>(id - _base);
+      return (id >= _base && i < _present.size() && _present[i])
+          ? &_values[i] : nullptr;
+    }
+
+    const auto i = _map.find(id);
+    return i != _map.end() ? &i->second : nullptr;
+  }
+
+  /// Returns the pointer to the value or nullptr.
+  T *find(K id) {
+    return const_cast<T*>(std::as_const(*this).find(id));
+  }
+
+  /// Checks whether the map contains the identifier.
+  bool contains(K id) const {
+    return find(id) != nullptr;
+  }
+
+  /// Applies the function to each (identifier, value) pair.
+  template <typename F>
+  void forEach(F f) const {
+    if (_isDense) {
+      for (std::size_t i = 0; i < _present.size(); i++) {
+        if (_present[i]) f(static_cast<K>(_base + i), _values[i]);
+      }
+    } else {
+      for (const auto &[id, value] : _map) f(id, value);
+    }
+  }
+
+  /// Applies the function to each (identifier, value) pair.
+  template <typename F>
+  void forEach(F f) {
+    if (_isDense) {
+      for (std::size_t i = 0; i < _present.size(); i++) {
+        if (_present[i]) f(static_cast<K>(_base + i), _values[i]);
+      }
+    } else {
+      for (auto &[id, value] : _map) f(id, value);
+    }
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Modification
+  //===--------------------------------------------------------------------===//
+
+  /// Reserves the space for the given number of entries.
+  void reserve(std::size_t n) {
+    if (_isDense) {
+      _values.reserve(n);
+      _present.reserve(n);
+    } else {
+      _map.reserve(n);
+    }
+  }
+
+  /// Inserts the entry if the identifier is not in the map.
+  /// Returns true if the entry has been inserted.
+  bool insert(K id, const T &value) {
+    if (_isDense && !fits(id)) {
+      makeSparse();
+    }
+
+    if (!_isDense) {
+      const bool isInserted = _map.emplace(id, value).second;
+      _size += isInserted;
+      return isInserted;
+    }
+
+    if (_present.empty()) {
+      _base = id;
+      _front = 0;
+    } else if (id < _base) {
+      // The array grows geometrically at the front as well: the headroom
+      // below the identifier makes descending insertions amortized O(1).
+      const std::size_t shift = std::min<std::size_t>(
+          std::max<std::size_t>(_base - id, _present.size()), _base);
+      _values.insert(_values.begin(), shift, T{});
+      _present.insert(_present.begin(), shift, 0);
+      _base -= shift;
+      _front += shift;
+    }
+
+    const std::size_t i = id - _base;
+    if (i >= _present.size()) {
+      _values.resize(i + 1);
+      _present.resize(i + 1, 0);
+    }
+    _front = std::min(_front, i);
+
+    if (_present[i]) {
+      return false;
+    }
+
+    _values[i] = value;
+    _present[i] = 1;
+    _size++;
+
+    return true;
+  }
+
+  /// Removes the entry (if any).
+  void erase(K id) {
+    if (!_isDense) {
+      _size -= _map.erase(id);
+    } else if (auto *value = find(id)) {
+      _present[value - _values.data()] = 0;
+      if (--_size == 0) {
+        clear();
+      }
+    }
+  }
+
+  /// Removes all the entries (the map becomes dense).
+  void clear() {
+    _values.clear();
+    _present.clear();
+    _map.clear();
+
+    _base = 0;
+    _front = 0;
+    _size = 0;
+    _isDense = true;
+  }
+
+private:
+  /// Checks whether the dense array may be extended to the identifier.
+  bool fits(K id) const {
+    if (_present.empty()) {
+      return true;
+    }
+
+    const std::size_t lower = std::min<std::size_t>(_base + _front, id);
+    const std::size_t upper = std::max<std::size_t>(
+        _base + _present.size(), static_cast<std::size_t>(id) + 1);
+
+    return upper - lower <= DENSITY * (_size + 1) + SLACK;
+  }
+
+  /// Moves the entries to the hash table.
+  void makeSparse() {
+    assert(_isDense);
+
+    _map.reserve(_size);
+    for (std::size_t i = 0; i < _present.size(); i++) {
+      if (_present[i]) {
+        _map.emplace(static_cast<K>(_base + i), _values[i]);
+      }
+    }
+
+    _values = std::vector<T>();
+    _present = std::vector<uint8_t>();
+    _isDense = false;
+  }
+
+  /// Dense form: values and presence marks indexed by (id - base).
+  K _base;
+  /// Index of the lowest inserted entry (the slots below are the headroom).
+  std::size_t _front;
+  std::vector<T> _values;
+  std::vector<uint8_t> _present;
+
+  /// Sparse form.
+  std::unordered_map<K, T> _map;
+
+  /// Number of entries.
+  std::size_t _size;
+  /// Current form of the map.
+  bool _isDense;
+};
+
+} // namespace eda::utils
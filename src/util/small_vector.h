@@ -0,0 +1,194 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+
+namespace eda::utils {
+
+/**
+ * \brief Implements a vector that stores up to N elements inline
+ *        (w/o heap allocation).
+ *
+ * Only trivially copyable elements are supported: they are moved by
+ * memcpy and are not destroyed. The inline buffer shares the space w/ the
+ * heap pointer, so the header takes 8 bytes only.
+ */
+template <typename T, std::size_t N>
+class SmallVector final {
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(N > 0);
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  SmallVector(): _size(0), _capacity(N) {}
+
+  template <typename InputIt>
+  SmallVector(InputIt first, InputIt last): SmallVector() {
+    assign(first, last);
+  }
+
+  SmallVector(std::initializer_list<T> list):
+      SmallVector(list.begin(), list.end()) {}
+
+  SmallVector(const SmallVector &other): SmallVector() {
+    assign(other.begin(), other.end());
+  }
+
+  SmallVector &operator =(const SmallVector &other) {
+    if (&other != this) {
+      assign(other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  ~SmallVector() {
+    if (!isInline()) {
+      ::operator delete(_heap);
+    }
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Access
+  //===--------------------------------------------------------------------===//
+
+  size_type size()     const { return _size; }
+  size_type capacity() const { return _capacity; }
+  bool empty()         const { return _size == 0; }
+
+  T *data()             { return isInline() ? inlineData() : _heap; }
+  const T *data() const { return isInline() ? inlineData() : _heap; }
+
+  iterator begin()              { return data(); }
+  iterator end()                { return data() + _size; }
+  const_iterator begin()  const { return data(); }
+  const_iterator end()    const { return data() + _size; }
+  const_iterator cbegin() const { return data(); }
+  const_iterator cend()   const { return data() + _size; }
+
+  reference operator[](size_type i) {
+    assert(i < _size);
+    return data()[i];
+  }
+
+  const_reference operator[](size_type i) const {
+    assert(i < _size);
+    return data()[i];
+  }
+
+  reference back()             { return (*this)[_size - 1]; }
+  const_reference back() const { return (*this)[_size - 1]; }
+
+  /// Checks whether the elements are stored inline.
+  bool isInline() const {
+    return _capacity == N;
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Modification
+  //===--------------------------------------------------------------------===//
+
+  void push_back(const T &value) {
+    if (_size == _capacity) {
+      // The value may refer to an element of the vector.
+      const T copy = value;
+      grow(2 * _capacity);
+      data()[_size++] = copy;
+    } else {
+      data()[_size++] = value;
+    }
+  }
+
+  void pop_back() {
+    assert(_size > 0);
+    _size--;
+  }
+
+  template <typename InputIt>
+  void assign(InputIt first, InputIt last) {
+    const auto size = static_cast<size_type>(std::distance(first, last));
+    _size = 0;
+    reserve(size);
+    std::copy(first, last, data());
+    _size = size;
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    auto *pos = const_cast<iterator>(first);
+    const auto *tail = std::copy(last, cend(), pos);
+    _size = tail - data();
+    return pos;
+  }
+
+  void resize(size_type size, const T &value = T()) {
+    reserve(size);
+    std::fill(data() + std::min<size_type>(_size, size), data() + size, value);
+    _size = size;
+  }
+
+  void reserve(size_type capacity) {
+    if (capacity > _capacity) {
+      grow(capacity);
+    }
+  }
+
+  void clear() {
+    _size = 0;
+  }
+
+  bool operator ==(const SmallVector &rhs) const {
+    return _size == rhs._size && std::equal(begin(), end(), rhs.begin());
+  }
+
+private:
+  T *inlineData() {
+    return std::launder(reinterpret_cast<T*>(_inline));
+  }
+
+  const T *inlineData() const {
+    return std::launder(reinterpret_cast<const T*>(_inline));
+  }
+
+  void grow(size_type capacity) {
+    auto *heap = static_cast<T*>(::operator new(capacity * sizeof(T)));
+    std::memcpy(static_cast<void*>(heap), data(), _size * sizeof(T));
+
+    if (!isInline()) {
+      ::operator delete(_heap);
+    }
+
+    _heap = heap;
+    _capacity = static_cast<uint32_t>(capacity);
+  }
+
+  uint32_t _size;
+  /// The elements are stored inline iff the capacity is N.
+  uint32_t _capacity;
+
+  union {
+    T *_heap;
+    alignas(T) unsigned char _inline[N * sizeof(T)];
+  };
+};
+
+} // namespace eda::utils
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "util/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace eda::utils {
+
+thread_local bool ThreadPool::_isWorker = false;
+
+std::size_t ThreadPool::defaultSize() {
+  const std::size_t n = std::thread::hardware_concurrency();
+  return n > 0 ? n : 1;
+}
+
+ThreadPool::ThreadPool(std::size_t nThreads): _stop(false) {
+  _workers.reserve(nThreads);
+  for (std::size_t i = 0; i < nThreads; i++) {
+    _workers.emplace_back([this]() { run(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+
+  _condition.notify_all();
+  for (auto &worker : _workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::parallelFor(
+    std::size_t n,
+    std::size_t grain,
+    const std::function<void(std::size_t, std::size_t)> &body) {
+  grain = std::max<std::size_t>(grain, 1);
+
+  const std::size_t nChunks = (n + grain - 1) / grain;
+  if (nChunks <= 1 || _workers.empty() || _isWorker) {
+    if (n > 0) {
+      body(0, n);
+    }
+    return;
+  }
+
+  // Chunks are taken dynamically by the helpers and the calling thread.
+  std::atomic<std::size_t> next = 0;
+  auto loop = [&]() {
+    for (auto i = next++; i < nChunks; i = next++) {
+      body(i * grain, std::min(n, (i + 1) * grain));
+    }
+  };
+
+  const auto nHelpers = std::min(_workers.size(), nChunks - 1);
+
+  std::vector<std::future<void>> helpers;
+  helpers.reserve(nHelpers);
+  for (std::size_t i = 0; i < nHelpers; i++) {
+    helpers.push_back(submit(loop));
+  }
+
+  loop();
+  for (auto &helper : helpers) {
+    helper.get();
+  }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    assert(!_stop);
+    _tasks.push(std::move(task));
+  }
+
+  _condition.notify_one();
+}
+
+void ThreadPool::run() {
+  _isWorker = true;
+
+  for (;;) {
+    std::function<void()> task;
+
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+
+      if (_stop && _tasks.empty()) {
+        return;
+      }
+
+      task = std::move(_tasks.front());
+      _tasks.pop();
+    }
+
+    task();
+  }
+}
+
+} // namespace eda::utils
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "util/singleton.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace eda::utils {
+
+/**
+ * \brief Implements a fixed-size pool of worker threads.
+ *
+ * The shared pool (see get()) uses all hardware threads. Tasks submitted
+ * from the pool's workers are allowed; parallelFor() called from a worker
+ * runs serially (to avoid waiting for the busy workers).
+ */
+class ThreadPool final : public eda::util::Singleton<ThreadPool> {
+public:
+  /// Default number of worker threads.
+  static std::size_t defaultSize();
+
+  explicit ThreadPool(std::size_t nThreads = defaultSize());
+  ~ThreadPool();
+
+  /// Returns the number of worker threads.
+  std::size_t size() const { return _workers.size(); }
+
+  /// Checks whether the current thread is a worker of some pool.
+  static bool isWorker() { return _isWorker; }
+
+  /// Submits the task and returns the future for its result.
+  template <typename F>
+  std::future<std::invoke_result_t<F>> submit(F &&task) {
+    using R = std::invoke_result_t<F>;
+
+    auto packaged =
+        std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+    auto future = packaged->get_future();
+
+    enqueue([packaged]() { (*packaged)(); });
+    return future;
+  }
+
+  /// Calls body(begin, end) for the chunks of [0, n) of the given size
+  /// (the calling thread participates) and waits for the completion.
+  void parallelFor(std::size_t n,
+                   std::size_t grain,
+                   const std::function<void(std::size_t, std::size_t)> &body);
+
+private:
+  void enqueue(std::function<void()> task);
+  void run();
+
+  std::vector<std::thread> _workers;
+  std::queue<std::function<void()>> _tasks;
+
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  bool _stop;
+
+  static thread_local bool _isWorker;
+};
+
+} // namespace eda::utils
@@ -113,3 +113,186 @@ TEST(CheckGNetTest, CheckNorAndnTest) {
 TEST(CheckGNetTest, CheckNorAndTest) {
   EXPECT_FALSE(checkNorAndTest(256));
 }
+
+TEST(CheckGNetTest, CheckDenseVarsTest) {
+  Gate::SignalList inputs;
+  Gate::Id outputId;
+  auto net = makeNor(1024, inputs, outputId);
+
+  // The solver size does not depend on the gate identifiers and versions.
+  Encoder encoder;
+  encoder.encode(*net, 0);
+  encoder.encode(*net, 1);
+
+  EXPECT_LE(encoder.context().solver().nVars(), 2 * net->nGates());
+}
+
+static Checker::Hints makeHints(const Gate::SignalList &lhsInputs,
+                                const std::vector<Gate::Id> &lhsOutputIds,
+                                const Gate::SignalList &rhsInputs,
+                                const std::vector<Gate::Id> &rhsOutputIds) {
+  using Link = Gate::Link;
+  using GateBinding = Checker::GateBinding;
+
+  GateBinding imap, omap;
+  for (std::size_t i = 0; i < lhsInputs.size(); i++) {
+    imap.insert({Link(lhsInputs[i].node()), Link(rhsInputs[i].node())});
+  }
+  for (std::size_t i = 0; i < lhsOutputIds.size(); i++) {
+    omap.insert({Link(lhsOutputIds[i]), Link(rhsOutputIds[i])});
+  }
+
+  Checker::Hints hints;
+  hints.sourceBinding = std::make_shared<GateBinding>(std::move(imap));
+  hints.targetBinding = std::make_shared<GateBinding>(std::move(omap));
+
+  return hints;
+}
+
+// Outputs: ~(x1 | ... | xN), (x1 & ... & xN) or (x1 | ... | xN), x1 ^ xN.
+static std::unique_ptr<GNet> makeOutputs(unsigned N,
+                                         bool isAnd,
+                                         Gate::SignalList &inputs,
+                                         std::vector<Gate::Id> &outputIds) {
+  auto net = std::make_unique<GNet>();
+
+  Gate::SignalList notInputs;
+  for (unsigned i = 0; i < N; i++) {
+    const auto inputId = net->addIn();
+    inputs.push_back(Gate::Signal::always(inputId));
+    notInputs.push_back(Gate::Signal::always(net->addNot(inputId)));
+  }
+
+  outputIds.push_back(net->addOut(net->addGate(GateSymbol::AND, notInputs)));
+  outputIds.push_back(net->addOut(
+      net->addGate(isAnd ? GateSymbol::AND : GateSymbol::OR, inputs)));
+  outputIds.push_back(net->addOut(
+      net->addXor(inputs.front().node(), inputs.back().node())));
+
+  net->sortTopologically();
+  return net;
+}
+
+TEST(CheckGNetTest, CheckOutputsTest) {
+  using Link = Gate::Link;
+
+  const unsigned N = 64;
+
+  Gate::SignalList lhsInputs, rhsInputs;
+  std::vector<Gate::Id> lhsOutputIds, rhsOutputIds;
+  auto lhs = makeOutputs(N, true, lhsInputs, lhsOutputIds);
+  auto rhs = makeOutputs(N, false, rhsInputs, rhsOutputIds);
+
+  const auto hints =
+      makeHints(lhsInputs, lhsOutputIds, rhsInputs, rhsOutputIds);
+
+  // Only the second outputs differ.
+  Checker checker;
+  Checker::Verdicts verdicts;
+  EXPECT_FALSE(checker.areEqualOutputs(*lhs, *rhs, hints, verdicts));
+
+  EXPECT_EQ(verdicts.size(), 3);
+  EXPECT_TRUE(verdicts.at(Link(lhsOutputIds[0])));
+  EXPECT_FALSE(verdicts.at(Link(lhsOutputIds[1])));
+  EXPECT_TRUE(verdicts.at(Link(lhsOutputIds[2])));
+}
+
+TEST(CheckGNetTest, CheckMiterModesTest) {
+  const unsigned N = 64;
+
+  Gate::SignalList lhsInputs, rhsInputs, badInputs;
+  std::vector<Gate::Id> lhsOutputIds, rhsOutputIds, badOutputIds;
+  auto lhs = makeOutputs(N, true, lhsInputs, lhsOutputIds);
+  auto rhs = makeOutputs(N, true, rhsInputs, rhsOutputIds);
+  auto bad = makeOutputs(N, false, badInputs, badOutputIds);
+
+  const auto equalHints =
+      makeHints(lhsInputs, lhsOutputIds, rhsInputs, rhsOutputIds);
+  const auto wrongHints =
+      makeHints(lhsInputs, lhsOutputIds, badInputs, badOutputIds);
+
+  // The single miter (default) and the output-by-output checks agree.
+  Checker checker;
+  EXPECT_TRUE(checker.areEqual(*lhs, *rhs, equalHints));
+  EXPECT_FALSE(checker.areEqual(*lhs, *bad, wrongHints));
+
+  Checker::Verdicts verdicts;
+  EXPECT_TRUE(checker.areEqualOutputs(*lhs, *rhs, equalHints, verdicts));
+  EXPECT_EQ(verdicts.size(), 3);
+
+  verdicts.clear();
+  EXPECT_FALSE(checker.areEqualOutputs(*lhs, *bad, wrongHints, verdicts));
+}
+
+// Wide nets: the k-th output is ~(xi & xj) (LHS) or (~xi | ~xj) (RHS);
+// the RHS output w/ the given index (if any) is (~xi & ~xj).
+static std::unique_ptr<GNet> makeWide(unsigned N,
+                                      unsigned M,
+                                      bool isLhs,
+                                      unsigned wrong,
+                                      Gate::SignalList &inputs,
+                                      std::vector<Gate::Id> &outputIds) {
+  auto net = std::make_unique<GNet>();
+
+  for (unsigned i = 0; i < N; i++) {
+    inputs.push_back(Gate::Signal::always(net->addIn()));
+  }
+
+  for (unsigned k = 0; k < M; k++) {
+    const auto xi = inputs[k % N].node();
+    const auto xj = inputs[(k + k / N + 1) % N].node();
+
+    const auto gid = isLhs
+        ? net->addNand(xi, xj)
+        : (k == wrong ? net->addAnd(net->addNot(xi), net->addNot(xj))
+                      : net->addOr(net->addNot(xi), net->addNot(xj)));
+    outputIds.push_back(net->addOut(gid));
+  }
+
+  net->sortTopologically();
+  return net;
+}
+
+TEST(CheckGNetTest, CheckParallelTest) {
+  using Link = Gate::Link;
+
+  const unsigned N = 64, M = 128, wrong = 77;
+
+  Gate::SignalList lhsInputs, rhsInputs, badInputs;
+  std::vector<Gate::Id> lhsOutputIds, rhsOutputIds, badOutputIds;
+  auto lhs = makeWide(N, M, true, M, lhsInputs, lhsOutputIds);
+  auto rhs = makeWide(N, M, false, M, rhsInputs, rhsOutputIds);
+  auto bad = makeWide(N, M, false, wrong, badInputs, badOutputIds);
+
+  const auto equalHints =
+      makeHints(lhsInputs, lhsOutputIds, rhsInputs, rhsOutputIds);
+  const auto wrongHints =
+      makeHints(lhsInputs, lhsOutputIds, badInputs, badOutputIds);
+
+  // The single miter (default) and the parallel checks agree.
+  Checker checker;
+  EXPECT_TRUE(checker.areEqual(*lhs, *rhs, equalHints));
+  EXPECT_FALSE(checker.areEqual(*lhs, *bad, wrongHints));
+
+  eda::utils::ThreadPool pool(4);
+  Checker::Verdicts verdicts;
+  EXPECT_TRUE(checker.areEqualOutputs(*lhs, *rhs, equalHints, verdicts,
+                                      0, false, pool));
+  EXPECT_EQ(verdicts.size(), M);
+
+  // All the outputs are checked.
+  verdicts.clear();
+  EXPECT_FALSE(checker.areEqualOutputs(*lhs, *bad, wrongHints, verdicts,
+                                       0, false, pool));
+  EXPECT_EQ(verdicts.size(), M);
+  for (unsigned k = 0; k < M; k++) {
+    EXPECT_EQ(verdicts.at(Link(lhsOutputIds[k])), k != wrong);
+  }
+
+  // The checks are stopped on the difference.
+  verdicts.clear();
+  EXPECT_FALSE(checker.areEqualOutputs(*lhs, *bad, wrongHints, verdicts,
+                                       8, true, pool));
+  ASSERT_EQ(verdicts.count(Link(lhsOutputIds[wrong])), 1);
+  EXPECT_FALSE(verdicts.at(Link(lhsOutputIds[wrong])));
+}
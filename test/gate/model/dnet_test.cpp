@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/model/dnet.h"
+#include "gate/model/gnet_test.h"
+#include "util/graph.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace eda::gate::model;
+using namespace eda::utils::graph;
+
+static bool checkDNet(const GNet &net) {
+  DNet dnet(net);
+
+  if (dnet.nGates() != net.nGates()) {
+    return false;
+  }
+
+  size_t nConnects = 0;
+  for (DNet::Index i = 0; i < dnet.nGates(); i++) {
+    const auto *gate = net.gate(i);
+
+    if (dnet.gateId(i) != gate->id() || dnet.index(gate->id()) != i) {
+      return false;
+    }
+    if (dnet.func(i) != gate->func() || dnet.arity(i) != gate->arity()) {
+      return false;
+    }
+    if (dnet.isTrigger(i) != gate->isTrigger()) {
+      return false;
+    }
+
+    const auto fanin = dnet.fanin(i);
+    for (size_t j = 0; j < gate->arity(); j++) {
+      const auto source = gate->input(j).node();
+      const auto expected = net.contains(source) ? dnet.index(source)
+                                                 : DNet::INVALID;
+      if (fanin[j] != expected) {
+        return false;
+      }
+      nConnects += (expected != DNet::INVALID);
+    }
+  }
+
+  if (dnet.nConnects() != nConnects) {
+    return false;
+  }
+
+  // Check that the dense graph is properly sorted.
+  const auto order = topologicalSort<DNet, DNet::Range>(dnet);
+  if (order.size() != dnet.nGates()) {
+    return false;
+  }
+
+  std::vector<size_t> position(dnet.nGates());
+  for (size_t i = 0; i < order.size(); i++) {
+    position[order[i]] = i;
+  }
+
+  for (DNet::Index i = 0; i < dnet.nGates(); i++) {
+    for (auto target : dnet.fanout(i)) {
+      if (dnet.hasEdge(target) && position[i] >= position[target]) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+TEST(DNetTest, DNetAndnTest) {
+  Gate::SignalList inputs;
+  Gate::Id outputId;
+  auto net = makeAndn(1024, inputs, outputId);
+  EXPECT_TRUE(checkDNet(*net));
+}
+
+TEST(DNetTest, DNetRandTest) {
+  auto net = makeRand(1024, 256);
+  EXPECT_TRUE(checkDNet(*net));
+}
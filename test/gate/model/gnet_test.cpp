@@ -6,13 +6,20 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "base/model/context.h"
 #include "gate/model/gnet_test.h"
+#include "util/bench.h"
 
 #include "gtest/gtest.h"
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 using namespace eda::gate::model;
 
@@ -51,7 +58,7 @@ static std::unique_ptr<GNet> makeNetn(GateSymbol gate,
     andInputs.push_back(Gate::Signal::always(notGateId));
   }
 
-  auto gateId = net->addGate(gate, inputs);
+  auto gateId = net->addGate(gate, andInputs);
   outputId = net->addOut(gateId);
 
   net->sortTopologically();
@@ -215,6 +222,165 @@ std::unique_ptr<GNet> makeRand(std::size_t nGates,
   return net;
 }
 
+// Checks that the gate order and the gate levels are consistent.
+static bool checkOrder(const GNet &net) {
+  if (!net.isSorted()) {
+    return false;
+  }
+
+  std::unordered_map<Gate::Id, std::size_t> position;
+  for (std::size_t i = 0; i < net.nGates(); i++) {
+    position[net.gate(i)->id()] = i;
+  }
+
+  for (std::size_t i = 0; i < net.nGates(); i++) {
+    const auto *gate = net.gate(i);
+
+    unsigned level = 0;
+    for (const auto &input : gate->inputs()) {
+      if (gate->isTrigger() || !net.contains(input.node())) {
+        continue;
+      }
+      if (position[input.node()] >= i) {
+        return false;
+      }
+      level = std::max(level, net.gateLevel(input.node()) + 1);
+    }
+
+    if (net.gateLevel(gate->id()) != level) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Random edits of a flat net (the order is maintained incrementally).
+static bool editRand(std::size_t nInputs, std::size_t nEdits) {
+  std::mt19937 gen(0);
+
+  GNet net;
+
+  Gate::Id clock = net.addIn();
+  std::vector<Gate::Id> gids;
+  for (std::size_t i = 0; i < nInputs; i++) {
+    gids.push_back(net.addIn());
+  }
+
+  // The order is maintained after the net is sorted.
+  net.sortTopologically();
+
+  for (std::size_t i = 0; i < nEdits; i++) {
+    auto random = [&]() {
+      return gids[std::uniform_int_distribution<std::size_t>(
+          0, gids.size() - 1)(gen)];
+    };
+
+    const auto lhs = Gate::Signal::always(random());
+    const auto rhs = Gate::Signal::always(random());
+
+    switch (std::uniform_int_distribution<int>(0, 3)(gen)) {
+    case 0: {
+      // Append a gate (or reuse the existing one).
+      const auto gid = net.addGate(GateSymbol::XOR, {lhs, rhs});
+      if (std::find(gids.begin(), gids.end(), gid) == gids.end()) {
+        gids.push_back(gid);
+      }
+      break;
+    }
+    case 1: {
+      // Rewire a gate (the new inputs may follow it in the order).
+      const auto gid = random();
+      const auto *gate = Gate::get(gid);
+      if (gate->isSource() || gate->isTrigger()
+                           || net.hasCombFlow(gid, {lhs, rhs})) {
+        continue;
+      }
+      net.setGate(gid, GateSymbol::AND, {lhs, rhs});
+      break;
+    }
+    case 2: {
+      // Make a trigger (combinational cycles are broken).
+      const auto gid = random();
+      if (Gate::get(gid)->isSource()) {
+        continue;
+      }
+      net.setGate(gid, GateSymbol::DFF, {lhs, Gate::Signal::posedge(clock)});
+      break;
+    }
+    case 3: {
+      // Remove a gate w/o fanout.
+      const auto gid = random();
+      if (Gate::get(gid)->isSource() || Gate::get(gid)->fanout() != 0) {
+        continue;
+      }
+      net.removeGate(gid);
+      gids.erase(std::find(gids.begin(), gids.end(), gid));
+      break;
+    }
+    }
+
+    if (!checkOrder(net)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Reference (allocating) check of the combinational flow.
+static bool hasCombFlowRef(Gate::Id gid, const Gate::SignalList &inputs) {
+  std::unordered_set<Gate::Id> targets;
+  for (const auto &input : inputs) {
+    if (input.node() == gid) {
+      return true;
+    }
+    targets.insert(input.node());
+  }
+
+  std::unordered_set<Gate::Id> reached{gid};
+  std::vector<Gate::Id> stack{gid};
+
+  while (!stack.empty()) {
+    const auto *gate = Gate::get(stack.back());
+    stack.pop_back();
+
+    for (const auto &link : gate->links()) {
+      if (targets.find(link.target) != targets.end()) {
+        return true;
+      }
+      if (!Gate::get(link.target)->isTrigger()
+          && reached.insert(link.target).second) {
+        stack.push_back(link.target);
+      }
+    }
+  }
+
+  return false;
+}
+
+// Random combinational flow queries (w/o trigger sources).
+static std::vector<std::pair<Gate::Id, Gate::SignalList>> makeCombFlowQueries(
+    const GNet &net, std::size_t nQueries) {
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<std::size_t> dist(0, net.nGates() - 1);
+
+  std::vector<std::pair<Gate::Id, Gate::SignalList>> queries;
+  while (queries.size() < nQueries) {
+    const auto gid = net.gate(dist(gen))->id();
+    if (Gate::get(gid)->isTrigger()) {
+      continue;
+    }
+
+    const Gate::SignalList inputs{
+        Gate::Signal::always(net.gate(dist(gen))->id()),
+        Gate::Signal::always(net.gate(dist(gen))->id())};
+    queries.emplace_back(gid, inputs);
+  }
+
+  return queries;
+}
+
 TEST(GNetTest, GNetOrTest) {
   Gate::SignalList inputs;
   Gate::Id outputId;
@@ -267,3 +433,327 @@ TEST(GNetTest, GNetRandTestIssue11877) {
   EXPECT_TRUE(net != nullptr);
 }
 
+TEST(GNetTest, GNetGateSizeTest) {
+  // Two fanout links are stored inline (w/ an 8-byte header); the inputs
+  // are allocated in the arena (12 bytes per input).
+  EXPECT_EQ(sizeof(eda::utils::SmallVector<Gate::Fanout, 2>), 24u);
+  EXPECT_LE(sizeof(Gate), 48u);
+}
+
+TEST(GNetTest, GNetContextTest) {
+  using GateContext = eda::base::model::DesignContext<GateBase>;
+
+  // Build independent designs concurrently.
+  auto build = [](GateContext &context, bool &result) {
+    GateContext::Scope scope(context);
+
+    auto net = makeRand(1024, 64);
+    const auto &storage = context.storage<GateBase>();
+
+    // Gate identifiers are local to the context.
+    result = net != nullptr && storage.size() >= net->nGates();
+    result = result && storage.bytesUsed() >= storage.size() * sizeof(Gate);
+    for (const auto *gate : net->gates()) {
+      result = result && gate->id() < storage.size();
+      result = result && Gate::get(gate->id()) == gate;
+    }
+  };
+
+  GateContext context1, context2;
+  bool result1 = false, result2 = false;
+
+  std::thread thread1(build, std::ref(context1), std::ref(result1));
+  std::thread thread2(build, std::ref(context2), std::ref(result2));
+
+  thread1.join();
+  thread2.join();
+
+  EXPECT_TRUE(result1);
+  EXPECT_TRUE(result2);
+}
+
+TEST(GNetTest, GNetRewireTest) {
+  const std::size_t N = 100000;
+
+  GNet net;
+  const auto x = net.addIn();
+  const auto y = net.addIn();
+
+  GNet::GateIdList inputs, gates;
+  for (std::size_t i = 0; i < N; i++) {
+    inputs.push_back(net.addIn());
+    gates.push_back(net.addAnd(x, inputs.back()));
+  }
+  EXPECT_EQ(Gate::get(x)->fanout(), N);
+
+  // Move all the fanout of x to y.
+  const auto start = std::chrono::high_resolution_clock::now();
+  for (std::size_t i = 0; i < N; i++) {
+    net.setGate(gates[i], GateSymbol::AND, {Gate::Signal::always(y),
+                                            Gate::Signal::always(inputs[i])});
+  }
+  const auto time = std::chrono::high_resolution_clock::now() - start;
+
+  EXPECT_EQ(Gate::get(x)->fanout(), 0u);
+  EXPECT_EQ(Gate::get(y)->fanout(), N);
+
+  for (const auto &link : Gate::get(y)->links()) {
+    EXPECT_EQ(Gate::get(link.target)->input(link.input).node(), y);
+  }
+
+  benchOut() << "BENCH rewire: " << N << " gates: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(time)
+                   .count()
+            << "ms" << std::endl;
+}
+
+TEST(GNetTest, GNetIncrementalSortTest) {
+  EXPECT_TRUE(editRand(64, 2048));
+}
+
+TEST(GNetTest, GNetBuildTest) {
+  const std::size_t N = 128 * 1024;
+
+  // Some gates are defined after their uses (as in parsers).
+  auto build = [N](bool isOrderKept) {
+    std::mt19937 gen(0);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    GNet net;
+    std::vector<Gate::Id> gids, placeholders;
+    for (std::size_t i = 0; i < 1024; i++) {
+      gids.push_back(net.addIn());
+    }
+    if (isOrderKept) {
+      net.sortTopologically();
+    }
+
+    while (net.nGates() < N) {
+      std::uniform_int_distribution<std::size_t> dist(0, gids.size() - 1);
+      const auto lhs = Gate::Signal::always(gids[dist(gen)]);
+      const auto rhs = Gate::Signal::always(gids[dist(gen)]);
+      gids.push_back(net.addGate(GateSymbol::AND, {lhs, rhs}));
+
+      if ((gids.size() & 15) == 0) {
+        placeholders.push_back(net.newGate());
+        gids.push_back(placeholders.back());
+      }
+    }
+    for (auto gid : placeholders) {
+      net.setGate(gid, GateSymbol::NOT, {Gate::Signal::always(net.addIn())});
+    }
+    net.sortTopologically();
+
+    const auto time = std::chrono::high_resolution_clock::now() - start;
+
+    EXPECT_TRUE(checkOrder(net));
+    return time;
+  };
+
+  // The order is maintained only after the first explicit sorting.
+  const auto buildTime = build(false);
+  const auto keepTime = build(true);
+
+  using std::chrono::milliseconds;
+  benchOut() << "BENCH build: " << N << " gates: "
+            << std::chrono::duration_cast<milliseconds>(buildTime).count()
+            << "ms, w/ the order maintained "
+            << std::chrono::duration_cast<milliseconds>(keepTime).count()
+            << "ms" << std::endl;
+}
+
+TEST(GNetTest, GNetLevelizeTest) {
+  std::mt19937 gen(0);
+
+  // The net is large enough to be sorted by parallel levelization.
+  GNet part;
+  std::vector<Gate::Id> gids;
+  for (std::size_t i = 0; i < 1024; i++) {
+    gids.push_back(part.addIn());
+  }
+  while (part.nGates() < GNet::LEVELIZE_THRESHOLD) {
+    std::uniform_int_distribution<std::size_t> dist(0, gids.size() - 1);
+    const auto lhs = Gate::Signal::always(gids[dist(gen)]);
+    const auto rhs = Gate::Signal::always(gids[dist(gen)]);
+    gids.push_back(part.addGate(GateSymbol::AND, {lhs, rhs}));
+  }
+
+  // The levels are maintained in the sorted net.
+  auto expected = part.levelize();
+
+  // The joint net is unsorted: the levels are computed from scratch.
+  GNet net;
+  net.addNet(part);
+  EXPECT_FALSE(net.isSorted());
+
+  auto levels = net.levelize();
+  EXPECT_EQ(levels.size(), expected.size());
+
+  for (std::size_t i = 0; i < levels.size() && i < expected.size(); i++) {
+    std::sort(levels[i].begin(), levels[i].end());
+    std::sort(expected[i].begin(), expected[i].end());
+    EXPECT_EQ(levels[i], expected[i]);
+  }
+
+  net.sortTopologically();
+  EXPECT_TRUE(checkOrder(net));
+}
+
+TEST(GNetTest, GNetLevelizeCycleTest) {
+  std::mt19937 gen(0);
+
+  GNet net;
+  net.beginBatch();
+
+  std::vector<Gate::Id> gids;
+  for (std::size_t i = 0; i < 1024; i++) {
+    gids.push_back(net.addIn());
+  }
+  while (net.nGates() < GNet::LEVELIZE_THRESHOLD) {
+    std::uniform_int_distribution<std::size_t> dist(0, gids.size() - 1);
+    const auto lhs = Gate::Signal::always(gids[dist(gen)]);
+    const auto rhs = Gate::Signal::always(gids[dist(gen)]);
+    gids.push_back(net.addGate(GateSymbol::AND, {lhs, rhs}));
+  }
+
+  // A combinational cycle (x, y) and a gate z depending on it.
+  const auto x = net.newGate();
+  const auto y = net.addAnd(gids[0], x);
+  net.setGate(x, GateSymbol::AND, {Gate::Signal::always(y),
+                                   Gate::Signal::always(gids[1])});
+  const auto z = net.addAnd(x, gids[2]);
+
+  net.finalize();
+  EXPECT_FALSE(net.isSorted());
+
+  const auto nGates = net.nGates();
+  net.sortTopologically();
+
+  // All the gates are kept in the net.
+  std::unordered_set<Gate::Id> placed;
+  for (const auto *gate : net.gates()) {
+    placed.insert(gate->id());
+  }
+  EXPECT_EQ(net.nGates(), nGates);
+  EXPECT_EQ(placed.size(), nGates);
+
+  // The gates that are not levelized are placed last.
+  std::unordered_set<Gate::Id> tail;
+  for (std::size_t i = nGates - 3; i < nGates; i++) {
+    tail.insert(net.gate(i)->id());
+  }
+  EXPECT_EQ(tail, (std::unordered_set<Gate::Id>{x, y, z}));
+}
+
+TEST(GNetTest, GNetCombFlowTest) {
+  std::mt19937 gen(0);
+
+  GNet part;
+  const auto clock = part.addIn();
+  std::vector<Gate::Id> gids;
+  for (std::size_t i = 0; i < 256; i++) {
+    gids.push_back(part.addIn());
+  }
+  for (std::size_t i = 0; i < 16 * 1024; i++) {
+    std::uniform_int_distribution<std::size_t> dist(0, gids.size() - 1);
+    const auto lhs = Gate::Signal::always(gids[dist(gen)]);
+    const auto rhs = Gate::Signal::always(gids[dist(gen)]);
+    gids.push_back((i & 63) == 0
+        ? part.addDff(lhs.node(), clock)
+        : part.addGate(GateSymbol::XOR, {lhs, rhs}));
+  }
+
+  // Level-based pruning is used in the sorted net.
+  part.sortTopologically();
+  EXPECT_TRUE(part.isSorted());
+  // No levels are available in the unsorted net.
+  GNet net;
+  net.addNet(part);
+  EXPECT_FALSE(net.isSorted());
+
+  const auto queries = makeCombFlowQueries(part, 16 * 1024);
+
+  std::vector<bool> expected;
+  const auto refStart = std::chrono::high_resolution_clock::now();
+  for (const auto &[gid, inputs] : queries) {
+    expected.push_back(hasCombFlowRef(gid, inputs));
+  }
+  const auto refTime = std::chrono::high_resolution_clock::now() - refStart;
+
+  std::size_t nSame = 0;
+  const auto start = std::chrono::high_resolution_clock::now();
+  for (std::size_t i = 0; i < queries.size(); i++) {
+    const auto &[gid, inputs] = queries[i];
+    nSame += (part.hasCombFlow(gid, inputs) == expected[i]);
+  }
+  const auto time = std::chrono::high_resolution_clock::now() - start;
+  EXPECT_EQ(nSame, queries.size());
+
+  nSame = 0;
+  for (std::size_t i = 0; i < queries.size(); i++) {
+    const auto &[gid, inputs] = queries[i];
+    nSame += (net.hasCombFlow(gid, inputs) == expected[i]);
+  }
+  EXPECT_EQ(nSame, queries.size());
+
+  using std::chrono::milliseconds;
+  benchOut() << "BENCH comb-flow: " << queries.size() << " queries: "
+            << std::chrono::duration_cast<milliseconds>(time).count()
+            << "ms, reference "
+            << std::chrono::duration_cast<milliseconds>(refTime).count()
+            << "ms" << std::endl;
+}
+
+TEST(GNetTest, GNetCombFlowOuterTest) {
+  GNet net;
+  const auto clock = net.addIn();
+  const auto x = net.addIn();
+  const auto y = net.addIn();
+  const auto g = net.addNot(net.addAnd(net.addOr(x, y), x));
+  net.sortTopologically();
+
+  // The path leaves the net (g -> h) and comes back (h -> k).
+  GNet outer;
+  const auto h = outer.addNot(g);
+  const auto k = net.addAnd(h, y);
+  EXPECT_TRUE(net.isSorted());
+  EXPECT_LT(net.gateLevel(k), net.gateLevel(g));
+  EXPECT_TRUE(net.hasCombFlow(g, {Gate::Signal::always(k)}));
+
+  // A trigger input is reached, but the paths do not go through it.
+  const auto d = net.addDff(g, clock);
+  const auto z = net.addAnd(d, x);
+  EXPECT_TRUE(net.hasCombFlow(g, {Gate::Signal::always(d)}));
+  EXPECT_FALSE(net.hasCombFlow(g, {Gate::Signal::always(z)}));
+}
+
+TEST(GNetTest, GNetBatchTest) {
+  GNet expected, net;
+  net.beginBatch();
+
+  // The same gates are added to both nets (the boundary is deferred).
+  for (auto *target : {&expected, &net}) {
+    const auto clock = target->addIn();
+    const auto x = target->addIn();
+    const auto y = target->addIn();
+    const auto q = target->newGate();
+    const auto z = target->addAnd(x, y);
+    const auto w = target->addOr(z, q);
+    target->addOut(w);
+    target->addGate(GateSymbol::ONE);
+    target->setDff(q, w, clock);
+  }
+
+  EXPECT_TRUE(net.isBatch());
+  net.finalize();
+  EXPECT_FALSE(net.isBatch());
+
+  EXPECT_EQ(net.nSourceLinks(), expected.nSourceLinks());
+  EXPECT_EQ(net.nTargetLinks(), expected.nTargetLinks());
+  EXPECT_EQ(net.nConstants(), expected.nConstants());
+  EXPECT_EQ(net.nTriggers(), expected.nTriggers());
+  EXPECT_EQ(net.nConnects(), expected.nConnects());
+
+  EXPECT_TRUE(checkOrder(net));
+}
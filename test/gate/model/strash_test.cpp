@@ -0,0 +1,233 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/model/gnet.h"
+#include "rtl/library/flibrary.h"
+#include "util/bench.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace eda::gate::model;
+using namespace eda::rtl::library;
+using namespace eda::rtl::model;
+
+using Clock = std::chrono::high_resolution_clock;
+
+//===----------------------------------------------------------------------===//
+// Legacy Strash (Lossy Key + Signature Check)
+//===----------------------------------------------------------------------===//
+
+struct LegacyKey final {
+  LegacyKey(uint32_t netId, GateSymbol func, const Gate::SignalList &inputs):
+      netId(netId), func(func), arity(inputs.size()), ihash(0) {
+    std::vector<size_t> hashes(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) {
+      hashes[i] = std::hash<Gate::Id>()(inputs[i].node());
+    }
+    if (func.isCommutative()) {
+      std::sort(hashes.begin(), hashes.end());
+    }
+    for (const auto hash : hashes) {
+      ihash = ihash * 37 + hash;
+    }
+  }
+
+  bool operator ==(const LegacyKey &rhs) const {
+    return std::tie(netId, func, arity, ihash)
+        == std::tie(rhs.netId, rhs.func, rhs.arity, rhs.ihash);
+  }
+
+  uint32_t netId;
+  uint16_t func;
+  uint16_t arity;
+  uint64_t ihash;
+};
+
+struct LegacyKeyHash final {
+  size_t operator()(const LegacyKey &key) const {
+    return ((key.netId * 37 + key.func) * 37 + key.arity) * 37 + key.ihash;
+  }
+};
+
+static bool hasSignature(const Gate *gate,
+                         GateSymbol func,
+                         const Gate::SignalList &inputs) {
+  if (func != gate->func() || inputs.size() != gate->arity()) {
+    return false;
+  }
+
+  std::unordered_set<Gate::Id> inputSet;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    inputSet.insert(inputs[i].node());
+    inputSet.insert(gate->input(i).node());
+  }
+
+  return inputSet.size() == inputs.size();
+}
+
+//===----------------------------------------------------------------------===//
+// Test Nets
+//===----------------------------------------------------------------------===//
+
+static GNet::GateIdList makeInputs(size_t size, GNet &net) {
+  GNet::GateIdList inputs(size);
+  for (size_t i = 0; i < size; i++) {
+    inputs[i] = net.addIn();
+  }
+  return inputs;
+}
+
+// Adders and multiplexors synthesized by the functional library.
+static std::unique_ptr<GNet> makeArith(size_t width, size_t count) {
+  auto net = std::make_unique<GNet>();
+  auto &library = FLibraryDefault::get();
+
+  for (size_t i = 0; i < count; i++) {
+    const auto x = makeInputs(width, *net);
+    const auto y = makeInputs(width, *net);
+    library.synth(width, FuncSymbol::ADD, {x, y}, *net);
+
+    const auto c0 = makeInputs(1, *net);
+    const auto c1 = makeInputs(1, *net);
+    library.synth(width, FuncSymbol::MUX, {c0, c1, x, y}, *net);
+  }
+
+  return net;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+TEST(StrashTest, StrashExactTest) {
+  GNet net;
+
+  const auto x = net.addIn();
+  const auto y = net.addIn();
+  const auto z = net.addIn();
+
+  // Commutative functions ignore the input order.
+  const auto xy = net.addAnd(x, y);
+  EXPECT_EQ(net.addAnd(y, x), xy);
+
+  // Edge events are a part of the signature.
+  const auto xyEdge = net.addGate(GateSymbol::AND,
+      {Gate::Signal::posedge(x), Gate::Signal::always(y)});
+  EXPECT_NE(xyEdge, xy);
+
+  // Input multisets are compared exactly.
+  const auto xxy = net.addGate(GateSymbol::OR,
+      {Gate::Signal::always(x), Gate::Signal::always(x),
+       Gate::Signal::always(y)});
+  const auto xyy = net.addGate(GateSymbol::OR,
+      {Gate::Signal::always(x), Gate::Signal::always(y),
+       Gate::Signal::always(y)});
+  EXPECT_NE(xxy, xyy);
+
+  // Long signatures are compared against the gate inputs.
+  Gate::SignalList inputs;
+  for (size_t i = 0; i < 8; i++) {
+    inputs.push_back(Gate::Signal::always(i & 1 ? x : z));
+  }
+  const auto wide = net.addGate(GateSymbol::XOR, inputs);
+  std::reverse(inputs.begin(), inputs.end());
+  EXPECT_EQ(net.addGate(GateSymbol::XOR, inputs), wide);
+  inputs[0] = Gate::Signal::always(y);
+  EXPECT_NE(net.addGate(GateSymbol::XOR, inputs), wide);
+
+  // Modified gates are removed from the table.
+  net.setGate(xy, GateSymbol::OR, {Gate::Signal::always(x),
+                                   Gate::Signal::always(z)});
+  EXPECT_NE(net.addAnd(x, y), xy);
+}
+
+TEST(StrashTest, StrashNetTest) {
+  GNet inputs;
+  const auto x = inputs.addIn();
+  const auto y = inputs.addIn();
+
+  // The same signatures in different nets do not collide.
+  GNet lhs, rhs;
+  const auto lhsXy = lhs.addAnd(x, y);
+  const auto rhsXy = rhs.addAnd(x, y);
+  EXPECT_NE(lhsXy, rhsXy);
+  EXPECT_EQ(lhs.addAnd(y, x), lhsXy);
+  EXPECT_EQ(rhs.addAnd(y, x), rhsXy);
+
+  // Modifying a gate of one net does not affect the other net.
+  lhs.setGate(lhsXy, GateSymbol::OR, {Gate::Signal::always(x),
+                                      Gate::Signal::always(y)});
+  EXPECT_EQ(rhs.addAnd(x, y), rhsXy);
+
+  const auto newXy = lhs.addAnd(x, y);
+  EXPECT_NE(newXy, lhsXy);
+  EXPECT_NE(newXy, rhsXy);
+}
+
+TEST(StrashTest, StrashBenchTest) {
+  auto net = makeArith(64, 64);
+
+  using Signature = std::tuple<GateSymbol, Gate::SignalList, Gate::Id>;
+
+  std::vector<Signature> signatures;
+  std::unordered_map<LegacyKey, Gate::Id, LegacyKeyHash> legacy;
+
+  for (const auto *gate : net->gates()) {
+    if (gate->isSource() || gate->func().isIdentity()) {
+      continue;
+    }
+    const Gate::SignalList inputs(gate->inputs().begin(),
+                                  gate->inputs().end());
+
+    signatures.emplace_back(gate->func(), inputs, gate->id());
+    legacy.insert({LegacyKey(net->id(), gate->func(), inputs), gate->id()});
+  }
+
+  const size_t nRounds = 10;
+
+  size_t nExact = 0;
+  const auto exactStart = Clock::now();
+  for (size_t round = 0; round < nRounds; round++) {
+    for (const auto &[func, inputs, gid] : signatures) {
+      const auto *gate = Gate::get(net->id(), func, inputs);
+      nExact += (gate != nullptr && gate->id() == gid);
+    }
+  }
+  const auto exactTime = Clock::now() - exactStart;
+
+  size_t nLegacy = 0;
+  const auto legacyStart = Clock::now();
+  for (size_t round = 0; round < nRounds; round++) {
+    for (const auto &[func, inputs, gid] : signatures) {
+      auto i = legacy.find(LegacyKey(net->id(), func, inputs));
+      if (i != legacy.end()) {
+        nLegacy += hasSignature(Gate::get(i->second), func, inputs);
+      }
+    }
+  }
+  const auto legacyTime = Clock::now() - legacyStart;
+
+  EXPECT_EQ(nExact, nRounds * signatures.size());
+  EXPECT_GT(nLegacy, 0);
+
+  using std::chrono::microseconds;
+  benchOut() << "BENCH strash: " << nRounds * signatures.size()
+            << " lookups: exact "
+            << std::chrono::duration_cast<microseconds>(exactTime).count()
+            << "us, legacy "
+            << std::chrono::duration_cast<microseconds>(legacyTime).count()
+            << "us" << std::endl;
+}
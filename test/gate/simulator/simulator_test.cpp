@@ -8,13 +8,22 @@
 
 #include "gate/model/gnet_test.h"
 #include "gate/simulator/simulator.h"
+#include "util/bench.h"
 
 #include "gtest/gtest.h"
 
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <random>
 
 using namespace eda::gate::model;
 using namespace eda::gate::simulator;
+using namespace eda::utils;
 
 static Simulator simulator;
 
@@ -60,6 +69,171 @@ bool simulatorAndnTest(unsigned N) {
   return simulatorTest(1ull << N, *net, inputs, output);
 }
 
+// Compares the bit-parallel simulation w/ the single-pattern one.
+static bool simulatorWordTest(const GNet &net,
+                              const Gate::SignalList &inputs,
+                              Gate::Id output) {
+  using Compiled = Simulator::Compiled;
+
+  GNet::LinkList in;
+  GNet::LinkList out{Gate::Link(output)};
+
+  for (auto input : inputs) {
+    in.push_back(Gate::Link(input.node()));
+  }
+
+  auto compiled = simulator.compile(net, in, out);
+
+  Compiled::WV words(in.size());
+  Compiled::WV results(out.size());
+
+  const std::uint64_t N = 1ull << in.size();
+  for (std::uint64_t base = 0; base < N; base += Compiled::WIDTH) {
+    Compiled::getPatterns(words, base);
+    compiled.simulate(results, words);
+
+    for (std::uint64_t i = base; i < N && i < base + Compiled::WIDTH; i++) {
+      std::uint64_t o;
+      compiled.simulate(o, i);
+
+      if (o != ((results[0] >> (i - base)) & 1)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// Random flat combinational net (the last gates are the outputs): the gate
+// inputs are taken from the last window gates (a small window makes the net
+// deep, a large one makes it wide).
+static std::unique_ptr<GNet> makeRandComb(std::size_t nInputs,
+                                          std::size_t nGates,
+                                          std::size_t nOutputs,
+                                          GNet::LinkList &in,
+                                          GNet::LinkList &out,
+                                          std::size_t window = 64) {
+  static const GateSymbol funcs[] = {
+    GateSymbol::NOT, GateSymbol::AND, GateSymbol::OR, GateSymbol::XOR,
+    GateSymbol::NAND, GateSymbol::NOR, GateSymbol::XNOR
+  };
+
+  std::mt19937 gen(0);
+  auto net = std::make_unique<GNet>();
+
+  std::vector<Gate::Id> gids;
+  for (std::size_t i = 0; i < nInputs; i++) {
+    gids.push_back(net->addIn());
+    in.push_back(Gate::Link(gids.back()));
+  }
+
+  while (gids.size() < nInputs + nGates) {
+    const auto func = funcs[gen() % std::size(funcs)];
+    const auto arity = (func == GateSymbol::NOT) ? 1 : 2 + gen() % 3;
+
+    Gate::SignalList inputs;
+    for (std::size_t j = 0; j < arity; j++) {
+      const auto k = gids.size() - 1 - gen() % std::min<std::size_t>(
+          gids.size(), window);
+      inputs.push_back(Gate::Signal::always(gids[k]));
+    }
+
+    const auto gid = net->addGate(func, inputs);
+    if (std::find(gids.begin(), gids.end(), gid) == gids.end()) {
+      gids.push_back(gid);
+    }
+  }
+
+  for (std::size_t i = 0; i < nOutputs; i++) {
+    out.push_back(Gate::Link(net->addOut(gids[gids.size() - 1 - i])));
+  }
+
+  net->sortTopologically();
+  return net;
+}
+
+// Random flat combinational net of independent cones (the last gate of
+// each cone is an output): the gate inputs are taken from the cone gates.
+static std::unique_ptr<GNet> makeCones(std::size_t nInputs,
+                                       std::size_t nCones,
+                                       std::size_t nConeGates,
+                                       GNet::LinkList &in,
+                                       GNet::LinkList &out) {
+  std::mt19937 gen(0);
+  auto net = std::make_unique<GNet>();
+
+  std::vector<Gate::Id> inputs;
+  for (std::size_t i = 0; i < nInputs; i++) {
+    inputs.push_back(net->addIn());
+    in.push_back(Gate::Link(inputs.back()));
+  }
+
+  for (std::size_t i = 0; i < nCones; i++) {
+    std::vector<Gate::Id> gids(inputs);
+    for (std::size_t j = 0; j < nConeGates; j++) {
+      const auto window = std::min<std::size_t>(gids.size(), 8);
+      const auto lhs = gids[gids.size() - 1 - gen() % window];
+      const auto rhs = gids[gen() % gids.size()];
+      gids.push_back((gen() & 1) ? net->addXor(lhs, rhs)
+                                 : net->addNand(lhs, rhs));
+    }
+    out.push_back(Gate::Link(net->addOut(gids.back())));
+  }
+
+  net->sortTopologically();
+  return net;
+}
+
+// Compares the block (SIMD) kernels w/ the word one.
+static bool simulatorBlockTest(std::size_t nWords) {
+  using Compiled = Simulator::Compiled;
+  using Clock = std::chrono::high_resolution_clock;
+
+  GNet::LinkList in, out;
+  auto net = makeRandComb(14, 4096, 16, in, out);
+
+  auto word = simulator.compile(*net, in, out);
+  auto block = simulator.compile(*net, in, out, nWords);
+
+  Compiled::WV wordIn(in.size()), wordOut(out.size());
+  Compiled::WV blockIn(in.size() * nWords), blockOut(out.size() * nWords);
+
+  const std::uint64_t N = 1ull << in.size();
+
+  // Expected values.
+  Compiled::WV expected;
+  for (std::uint64_t base = 0; base < N; base += Compiled::WIDTH) {
+    Compiled::getPatterns(wordIn, base);
+    word.simulate(wordOut, wordIn);
+    expected.insert(expected.end(), wordOut.begin(), wordOut.end());
+  }
+
+  const auto start = Clock::now();
+  for (std::uint64_t base = 0; base < N; base += block.nPatterns()) {
+    Compiled::getPatterns(blockIn, base, nWords);
+    block.simulate(blockOut, blockIn);
+
+    for (std::size_t j = 0; j < nWords; j++) {
+      const auto w = (base / Compiled::WIDTH) + j;
+      for (std::size_t i = 0; i < out.size(); i++) {
+        if (blockOut[i * nWords + j] != expected[w * out.size() + i]) {
+          return false;
+        }
+      }
+    }
+  }
+  const auto time = Clock::now() - start;
+
+  benchOut() << "BENCH simulator: " << nWords << " word(s) per value: "
+            << std::dec << N << " patterns in "
+            << std::chrono::duration_cast<std::chrono::microseconds>(time)
+                   .count()
+            << "us" << std::endl;
+
+  return true;
+}
+
 TEST(SimulatorGNetTest, SimulatorNorTest) {
   EXPECT_TRUE(simulatorNorTest(4));
 }
@@ -67,3 +241,486 @@ TEST(SimulatorGNetTest, SimulatorNorTest) {
 TEST(SimulatorGNetTest, SimulatorAndnTest) {
   EXPECT_TRUE(simulatorAndnTest(4));
 }
+
+TEST(SimulatorGNetTest, SimulatorWordTest) {
+  Gate::SignalList norInputs, andnInputs;
+  Gate::Id norOutput, andnOutput;
+
+  auto norNet = makeNor(10, norInputs, norOutput);
+  auto andnNet = makeAndn(3, andnInputs, andnOutput);
+
+  EXPECT_TRUE(simulatorWordTest(*norNet, norInputs, norOutput));
+  EXPECT_TRUE(simulatorWordTest(*andnNet, andnInputs, andnOutput));
+}
+
+TEST(SimulatorGNetTest, SimulatorIndexTest) {
+  // The gates of the net read the inputs of the other net.
+  GNet outer;
+  const auto a = outer.addIn();
+  const auto b = outer.addIn();
+
+  GNet net;
+  const auto x = net.addAnd(a, b);
+  const auto y = net.addOr(x, a);
+  const auto z = net.addXor(b, y);
+  net.addOut(z);
+  net.sortTopologically();
+
+  GNet::LinkList in(net.sourceLinks().begin(), net.sourceLinks().end());
+  EXPECT_EQ(in.size(), 4u);
+
+  auto compiled = simulator.compile(net, in, {Gate::Link(z)});
+  for (std::size_t i = 0; i < in.size(); i++) {
+    EXPECT_FALSE(in[i].isPort());
+    EXPECT_EQ(compiled.getIndex(in[i]), i);
+  }
+  // The gates follow the inputs: x, y, z.
+  EXPECT_EQ(compiled.getIndex(Gate::Link(z)), in.size() + 2);
+}
+
+TEST(SimulatorGNetTest, SimulatorOpcodeTest) {
+  using Compiled = Simulator::Compiled;
+
+  GNet net;
+  Gate::SignalList inputs;
+  for (unsigned i = 0; i < 6; i++) {
+    inputs.push_back(Gate::Signal::always(net.addIn()));
+  }
+
+  // All the combinational functions of different arities.
+  const GateSymbol funcs[] = {
+    GateSymbol::NOP, GateSymbol::NOT,
+    GateSymbol::AND, GateSymbol::OR,  GateSymbol::XOR,
+    GateSymbol::NAND, GateSymbol::NOR, GateSymbol::XNOR
+  };
+
+  std::vector<std::pair<GateSymbol, unsigned>> gates;
+  GNet::LinkList out;
+  for (const auto func : funcs) {
+    for (unsigned arity : {1, 2, 3, 5}) {
+      const bool isUnary = (func == GateSymbol::NOP || func == GateSymbol::NOT);
+      if (isUnary && arity != 1) {
+        continue;
+      }
+      const Gate::SignalList args(inputs.begin(), inputs.begin() + arity);
+      out.push_back(Gate::Link(net.addOut(net.addGate(func, args))));
+      gates.emplace_back(func, arity);
+    }
+  }
+  out.push_back(Gate::Link(net.addOut(net.addGate(GateSymbol::ONE))));
+  gates.emplace_back(GateSymbol::ONE, 0);
+  net.sortTopologically();
+
+  GNet::LinkList in;
+  for (auto input : inputs) {
+    in.push_back(Gate::Link(input.node()));
+  }
+
+  auto compiled = simulator.compile(net, in, out);
+
+  Compiled::WV words(in.size());
+  Compiled::WV results(out.size());
+
+  Compiled::getPatterns(words, 0);
+  compiled.simulate(results, words);
+
+  for (std::size_t i = 0; i < gates.size(); i++) {
+    const auto [func, arity] = gates[i];
+
+    for (unsigned p = 0; p < Compiled::WIDTH; p++) {
+      const unsigned bits = p & ((1u << arity) - 1);
+      const unsigned ones = __builtin_popcount(bits);
+
+      bool expected;
+      switch (func) {
+      case GateSymbol::NOP  : expected = bits;            break;
+      case GateSymbol::NOT  : expected = !bits;           break;
+      case GateSymbol::AND  : expected = (ones == arity); break;
+      case GateSymbol::OR   : expected = (ones != 0);     break;
+      case GateSymbol::XOR  : expected = (ones & 1);      break;
+      case GateSymbol::NAND : expected = (ones != arity); break;
+      case GateSymbol::NOR  : expected = (ones == 0);     break;
+      case GateSymbol::XNOR : expected = !(ones & 1);     break;
+      default               : expected = true;            break;
+      }
+
+      EXPECT_EQ((results[i] >> p) & 1, expected) << func << "/" << arity;
+    }
+  }
+}
+
+TEST(SimulatorGNetTest, SimulatorBlockTest) {
+  EXPECT_TRUE(simulatorBlockTest(1));
+  EXPECT_TRUE(simulatorBlockTest(4));
+  EXPECT_TRUE(simulatorBlockTest(8));
+}
+
+TEST(SimulatorGNetTest, SimulatorNativeTest) {
+  using Compiled = Simulator::Compiled;
+  using Clock = std::chrono::high_resolution_clock;
+
+  GNet::LinkList in, out;
+  auto net = makeRandComb(16, 2048, 16, in, out);
+
+  // The code is cached in a fresh directory.
+  const auto cache = std::filesystem::temp_directory_path()
+                   / ("utopia-sim-test-" + std::to_string(getpid()));
+  setenv("UTOPIA_SIM_CACHE", cache.c_str(), 1);
+
+  const auto buildStart = Clock::now();
+  auto native = simulator.compileNative(*net, in, out);
+  const auto buildTime = Clock::now() - buildStart;
+  ASSERT_TRUE(native.isNative());
+
+  // The second compilation loads the cached object.
+  const auto loadStart = Clock::now();
+  auto cached = simulator.compileNative(*net, in, out);
+  const auto loadTime = Clock::now() - loadStart;
+  EXPECT_TRUE(cached.isNative());
+
+  // The cached object built from another program w/ the same hash is not
+  // loaded: the code is rebuilt (the cache is left as is).
+  for (const auto &entry : std::filesystem::directory_iterator(cache)) {
+    if (entry.path().extension() == ".sig") {
+      std::ofstream(entry.path()) << "collision";
+    }
+  }
+  auto collided = simulator.compileNative(*net, in, out);
+  EXPECT_TRUE(collided.isNative());
+
+  // No temporary files are left.
+  for (const auto &entry : std::filesystem::directory_iterator(cache)) {
+    const auto extension = entry.path().extension();
+    EXPECT_TRUE(extension == ".so" || extension == ".sig");
+  }
+
+  auto interpreted = simulator.compile(*net, in, out);
+
+  Compiled::WV words(in.size());
+  Compiled::WV expected(out.size()), results(out.size());
+
+  const std::uint64_t N = 1ull << in.size();
+
+  Clock::duration nativeTime{}, interpretedTime{};
+  bool equal = true;
+
+  for (std::uint64_t base = 0; base < N; base += Compiled::WIDTH) {
+    Compiled::getPatterns(words, base);
+
+    const auto start = Clock::now();
+    interpreted.simulate(expected, words);
+    const auto middle = Clock::now();
+    cached.simulate(results, words);
+    const auto end = Clock::now();
+
+    interpretedTime += middle - start;
+    nativeTime += end - middle;
+    equal &= (expected == results);
+
+    collided.simulate(results, words);
+    equal &= (expected == results);
+  }
+
+  EXPECT_TRUE(equal);
+
+  // Triggers: the native code and the bytecode go through the same states.
+  GNet seq;
+  const auto d = seq.addIn(), clk = seq.addIn();
+  const auto rst = seq.addIn(), set = seq.addIn();
+  const auto q0 = seq.addDff(d, clk);
+  const auto q1 = seq.addLatch(seq.addXor(d, q0), clk);
+  const auto q2 = seq.addDffrs(seq.addAnd(q0, q1), clk, rst,
+                               seq.addAnd(set, seq.addNot(rst)));
+  GNet::LinkList seqIn{Gate::Link(d), Gate::Link(clk),
+                       Gate::Link(rst), Gate::Link(set)};
+  GNet::LinkList seqOut{Gate::Link(seq.addOut(q2))};
+  seq.sortTopologically();
+
+  auto seqNative = simulator.compileNative(seq, seqIn, seqOut);
+  auto seqInterpreted = simulator.compile(seq, seqIn, seqOut);
+  EXPECT_TRUE(seqNative.isNative());
+
+  std::mt19937_64 gen(0);
+  Compiled::WV seqExpected(1), seqResults(1);
+  for (std::size_t cycle = 0; cycle < 64; cycle++) {
+    Compiled::WV values{gen(), gen(), gen() & gen(), gen()};
+    seqNative.simulate(seqResults, values);
+    seqInterpreted.simulate(seqExpected, values);
+    EXPECT_EQ(seqResults, seqExpected);
+  }
+
+  // The cache that is accessible to others is not used.
+  using std::filesystem::perms;
+  std::filesystem::permissions(cache, perms::group_write | perms::others_write,
+                               std::filesystem::perm_options::add);
+  auto shared = simulator.compileNative(*net, in, out);
+  EXPECT_FALSE(shared.isNative());
+
+  std::filesystem::remove_all(cache);
+
+  using std::chrono::milliseconds;
+  benchOut() << std::dec << "BENCH native: " << N << " patterns: native "
+            << std::chrono::duration_cast<milliseconds>(nativeTime).count()
+            << "ms, bytecode "
+            << std::chrono::duration_cast<milliseconds>(interpretedTime)
+                   .count()
+            << "ms; build "
+            << std::chrono::duration_cast<milliseconds>(buildTime).count()
+            << "ms, cached load "
+            << std::chrono::duration_cast<milliseconds>(loadTime).count()
+            << "ms" << std::endl;
+}
+
+TEST(SimulatorGNetTest, SimulatorEventDrivenTest) {
+  using Compiled = Simulator::Compiled;
+
+  // Independent sequential blocks (counters w/ clock and enable): mostly
+  // idle.
+  const std::size_t nBlocks = 256;
+  const std::size_t nBits = 8;
+
+  GNet net;
+  GNet::LinkList in, out;
+
+  for (std::size_t i = 0; i < nBlocks; i++) {
+    const auto clk = net.addIn();
+    const auto ena = net.addIn();
+    in.push_back(Gate::Link(clk));
+    in.push_back(Gate::Link(ena));
+
+    // q[j] <= q[j] ^ (ena & q[0] & ... & q[j-1]).
+    std::vector<Gate::Id> q;
+    for (std::size_t j = 0; j < nBits; j++) {
+      q.push_back(net.newGate());
+    }
+    auto carry = ena;
+    for (std::size_t j = 0; j < nBits; j++) {
+      net.setDff(q[j], net.addXor(q[j], carry), clk);
+      carry = net.addAnd(carry, q[j]);
+      out.push_back(Gate::Link(net.addOut(q[j])));
+    }
+  }
+  net.sortTopologically();
+
+  auto events = simulator.compileEventDriven(net, in, out);
+  auto full = simulator.compile(net, in, out);
+  EXPECT_TRUE(events.isEventDriven());
+
+  Compiled::WV values(in.size(), 0);
+  Compiled::WV expected(out.size()), results(out.size());
+
+  std::mt19937_64 gen(0);
+  std::size_t nEvaluated = 0;
+
+  const std::size_t nCycles = 256;
+  for (std::size_t cycle = 0; cycle < nCycles; cycle++) {
+    // A single block is clocked at a time.
+    const auto block = (cycle / 16) % nBlocks;
+    std::fill(values.begin(), values.end(), 0);
+    values[2 * block] = (cycle & 1) ? ~Compiled::W{0} : 0;
+    values[2 * block + 1] = gen();
+
+    events.simulate(results, values);
+    full.simulate(expected, values);
+    EXPECT_EQ(results, expected);
+
+    if (cycle > 0) {
+      nEvaluated += events.nEvaluated();
+    }
+  }
+
+  // The activity is much lower than the net size.
+  const std::size_t nInstructions = net.nGates() - net.nSourceLinks();
+  EXPECT_LT(nEvaluated, (nCycles - 1) * nInstructions / 16);
+
+  benchOut() << std::dec << "BENCH event-driven: " << nCycles << " cycles: "
+            << nEvaluated << " evaluations vs. "
+            << (nCycles - 1) * nInstructions << " (full)" << std::endl;
+}
+
+TEST(SimulatorGNetTest, SimulatorRunTest) {
+  using Compiled = Simulator::Compiled;
+
+  GNet net;
+  const auto d = net.addIn(), clk = net.addIn(), ena = net.addIn();
+  const auto rst = net.addIn(), set = net.addIn();
+
+  // Shift register, negedge DFF, latch, and DFF w/ async reset/set.
+  const auto s1 = net.addDff(d, clk);
+  const auto s2 = net.addDff(s1, clk);
+  const auto n1 = net.addGate(GateSymbol::DFF,
+      {Gate::Signal::always(d), Gate::Signal::negedge(clk)});
+  const auto l1 = net.addLatch(d, ena);
+  const auto r1 = net.addDffrs(d, clk, rst, set);
+
+  GNet::LinkList in, out;
+  for (const auto input : {d, clk, ena, rst, set}) {
+    in.push_back(Gate::Link(input));
+  }
+  for (const auto output : {s1, s2, n1, l1, r1}) {
+    out.push_back(Gate::Link(net.addOut(output)));
+  }
+  net.sortTopologically();
+
+  // Cycles: d, clk, ena, rst, set -> s1, s2, n1, l1, r1.
+  const std::vector<std::pair<std::string, std::string>> cycles = {
+    {"10000", "00000"},
+    {"11000", "10001"}, // posedge
+    {"00000", "10001"}, // negedge
+    {"01000", "01000"}, // posedge
+    {"10100", "01110"}, // negedge, transparent latch
+    {"00100", "01100"}, // transparent latch
+    {"10000", "01100"}, // closed latch
+    {"11000", "10101"}, // posedge
+    {"11010", "10100"}, // async reset
+    {"11001", "10101"}, // async set
+    {"01000", "10101"},
+    {"00000", "10001"}  // negedge
+  };
+
+  Compiled::WV values, expected;
+  for (const auto &[inputs, outputs] : cycles) {
+    for (const auto bit : inputs) {
+      values.push_back(bit == '1' ? ~Compiled::W{0} : 0);
+    }
+    for (const auto bit : outputs) {
+      expected.push_back(bit == '1' ? ~Compiled::W{0} : 0);
+    }
+  }
+
+  auto compiled = simulator.compile(net, in, out);
+  auto events = simulator.compileEventDriven(net, in, out);
+
+  Compiled::WV results(expected.size());
+  compiled.run(cycles.size(), values, results);
+  EXPECT_EQ(results, expected);
+
+  std::fill(results.begin(), results.end(), 0);
+  events.run(cycles.size(), values, results);
+  EXPECT_EQ(results, expected);
+
+  auto compact = simulator.compileCompact(net, in, out);
+
+  std::fill(results.begin(), results.end(), 0);
+  compact.run(cycles.size(), values, results);
+  EXPECT_EQ(results, expected);
+}
+
+TEST(SimulatorGNetTest, SimulatorParallelTest) {
+  using Compiled = Simulator::Compiled;
+
+  // Wide net: a few levels of thousands of gates.
+  GNet::LinkList in, out;
+  auto net = makeRandComb(16, 16384, 64, in, out, 4096);
+
+  const std::size_t nWords = 4;
+  const std::size_t nBlocks = 64;
+
+  auto compiled = simulator.compile(*net, in, out, nWords);
+  ThreadPool pool(4);
+  auto levels = simulator.compileLevelParallel(*net, in, out, nWords, pool);
+  EXPECT_TRUE(levels.isLevelParallel());
+
+  Compiled::WV batchIn(nBlocks * in.size() * nWords);
+  Compiled::WV expected(nBlocks * out.size() * nWords);
+
+  Compiled::WV blockIn(in.size() * nWords), blockOut(out.size() * nWords);
+  for (std::size_t k = 0; k < nBlocks; k++) {
+    Compiled::getPatterns(blockIn, k * compiled.nPatterns(), nWords);
+    std::copy(blockIn.begin(), blockIn.end(),
+              batchIn.begin() + k * blockIn.size());
+
+    compiled.simulate(blockOut, blockIn);
+    std::copy(blockOut.begin(), blockOut.end(),
+              expected.begin() + k * blockOut.size());
+
+    // Level-parallel simulation.
+    Compiled::WV levelsOut(blockOut.size());
+    levels.simulate(levelsOut, blockIn);
+    EXPECT_EQ(levelsOut, blockOut);
+  }
+
+  // Pattern-parallel simulation.
+  Compiled::WV results(expected.size());
+
+  const auto sequential = compiled.simulateBatch(results, batchIn, 1, pool);
+  EXPECT_EQ(results, expected);
+  EXPECT_EQ(sequential.nPatterns, nBlocks * compiled.nPatterns());
+
+  std::fill(results.begin(), results.end(), 0);
+  const auto parallel = compiled.simulateBatch(results, batchIn, 0, pool);
+  EXPECT_EQ(results, expected);
+  EXPECT_EQ(parallel.nThreads, pool.size() + 1);
+
+  // The level-parallel program is evaluated sequentially in the blocks.
+  std::fill(results.begin(), results.end(), 0);
+  levels.simulateBatch(results, batchIn, 0, pool);
+  EXPECT_EQ(results, expected);
+
+  benchOut() << std::dec << "BENCH parallel: " << sequential.nPatterns
+            << " patterns: 1 thread "
+            << static_cast<std::uint64_t>(sequential.patternsPerSecond())
+            << " patterns/s, " << parallel.nThreads << " threads "
+            << static_cast<std::uint64_t>(parallel.patternsPerSecond())
+            << " patterns/s" << std::endl;
+}
+
+TEST(SimulatorGNetTest, SimulatorCompactTest) {
+  using Compiled = Simulator::Compiled;
+  using Clock = std::chrono::high_resolution_clock;
+
+  // Deep net: thousands of levels of a few gates.
+  GNet::LinkList in, out;
+  auto net = makeRandComb(16, 16384, 16, in, out, 16);
+
+  const std::size_t nWords = 8;
+  const std::size_t nBlocks = 128;
+
+  auto compiled = simulator.compile(*net, in, out, nWords);
+  auto compact = simulator.compileCompact(*net, in, out, nWords);
+  EXPECT_LT(compact.nValues() * 16, compiled.nValues());
+
+  Compiled::WV blockIn(in.size() * nWords);
+  Compiled::WV expected(out.size() * nWords), results(expected.size());
+
+  Clock::duration compiledTime{}, compactTime{};
+  for (std::size_t k = 0; k < nBlocks; k++) {
+    Compiled::getPatterns(blockIn, k * compiled.nPatterns(), nWords);
+
+    auto start = Clock::now();
+    compiled.simulate(expected, blockIn);
+    compiledTime += Clock::now() - start;
+
+    start = Clock::now();
+    compact.simulate(results, blockIn);
+    compactTime += Clock::now() - start;
+
+    EXPECT_EQ(results, expected);
+  }
+
+  using std::chrono::microseconds;
+  benchOut() << std::dec << "BENCH compact: " << compiled.nValues()
+            << " values in "
+            << std::chrono::duration_cast<microseconds>(compiledTime).count()
+            << "us, " << compact.nValues() << " values in "
+            << std::chrono::duration_cast<microseconds>(compactTime).count()
+            << "us" << std::endl;
+}
+
+TEST(SimulatorGNetTest, SimulatorCompileTest) {
+  using Clock = std::chrono::high_resolution_clock;
+
+  GNet::LinkList in, out;
+  auto net = makeCones(64, 4096, 256, in, out);
+
+  const auto start = Clock::now();
+  auto compiled = simulator.compile(*net, in, out);
+  const auto time = Clock::now() - start;
+
+  EXPECT_EQ(compiled.nValues(), net->nGates());
+
+  benchOut() << std::dec << "BENCH compile: " << net->nGates() << " gates in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(time)
+                   .count()
+            << "ms" << std::endl;
+}
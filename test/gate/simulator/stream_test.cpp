@@ -0,0 +1,222 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/simulator/stream.h"
+
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace eda::gate::model;
+using namespace eda::gate::simulator;
+
+// Net w/ 12 inputs and 8 outputs.
+static void makeNet(GNet &net, GNet::LinkList &in, GNet::LinkList &out) {
+  std::vector<Gate::Id> x;
+  for (std::size_t i = 0; i < 12; i++) {
+    x.push_back(net.addIn());
+    in.push_back(Gate::Link(x.back()));
+  }
+
+  std::vector<Gate::Id> y;
+  for (std::size_t i = 0; i < 6; i++) {
+    y.push_back(net.addXor(x[2 * i], x[2 * i + 1]));
+  }
+  y.push_back(net.addAnd(net.addAnd(x[0], x[3]), net.addAnd(x[5], x[9])));
+  y.push_back(net.addNot(net.addOr(net.addOr(x[4], x[7]), x[11])));
+
+  for (const auto gid : y) {
+    out.push_back(Gate::Link(net.addOut(gid)));
+  }
+  net.sortTopologically();
+}
+
+static std::string toHex(std::uint64_t value, std::size_t width) {
+  std::stringstream stream;
+  stream << std::hex;
+  for (std::size_t i = (width + 3) / 4; i > 0; i--) {
+    stream << ((value >> (4 * (i - 1))) & 0xf);
+  }
+  return stream.str();
+}
+
+TEST(StreamTest, StreamHexTest) {
+  Simulator simulator;
+  GNet net;
+  GNet::LinkList in, out;
+  makeNet(net, in, out);
+
+  auto reference = simulator.compile(net, in, out);
+  auto compiled = simulator.compile(net, in, out, 4);
+
+  const auto dir = std::filesystem::temp_directory_path()
+                 / ("utopia-stream-test-" + std::to_string(getpid()));
+  std::filesystem::create_directories(dir);
+
+  const auto stimulusPath = (dir / "stimulus.hex").string();
+  const auto responsePath = (dir / "response.hex").string();
+  const auto goldenPath = (dir / "golden.hex").string();
+
+  // The number of vectors is not a multiple of the block size.
+  const std::size_t nVectors = 1000;
+
+  std::mt19937 gen(0);
+  std::vector<std::string> expected;
+  {
+    std::ofstream stimulus(stimulusPath);
+    stimulus << "# Test vectors\n";
+    for (std::size_t i = 0; i < nVectors; i++) {
+      const std::uint64_t vector = gen() & 0xfff;
+      stimulus << toHex(vector, in.size()) << "\n";
+
+      std::uint64_t response;
+      reference.simulate(response, vector);
+      expected.push_back(toHex(response, out.size()));
+    }
+  }
+
+  // The responses are written.
+  {
+    VectorReader stimulus(stimulusPath, in.size(), VectorFormat::HEX);
+    VectorWriter response(responsePath, out.size(), VectorFormat::HEX);
+    EXPECT_TRUE(stimulus.isOpen() && response.isOpen());
+
+    const auto stats = simulate(compiled, stimulus, &response);
+    EXPECT_EQ(stats.nVectors, nVectors);
+  }
+
+  std::vector<std::string> results;
+  {
+    std::ifstream response(responsePath);
+    for (std::string line; std::getline(response, line);) {
+      results.push_back(line);
+    }
+  }
+  EXPECT_EQ(results, expected);
+
+  // The responses are compared w/ the golden ones (w/ a single mismatch).
+  expected[777][0] = expected[777][0] == '0' ? '1' : '0';
+  {
+    std::ofstream golden(goldenPath);
+    for (const auto &line : expected) {
+      golden << line << "\n";
+    }
+  }
+  {
+    VectorReader stimulus(stimulusPath, in.size(), VectorFormat::HEX);
+    VectorReader golden(goldenPath, out.size(), VectorFormat::HEX);
+
+    const auto stats = simulate(compiled, stimulus, nullptr, &golden);
+    EXPECT_EQ(stats.nVectors, nVectors);
+    EXPECT_EQ(stats.nMismatches, 1);
+    EXPECT_EQ(stats.firstMismatch, 777);
+  }
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST(StreamTest, StreamHexFormatTest) {
+  const auto dir = std::filesystem::temp_directory_path()
+                 / ("utopia-stream-test-" + std::to_string(getpid()));
+  std::filesystem::create_directories(dir);
+
+  const auto path = (dir / "vectors.hex").string();
+
+  // The prefixes and the trailing comments are accepted.
+  {
+    std::ofstream vectors(path);
+    vectors << "0x0a5\n" << "0XfF # comment\n" << "  123\t\n";
+  }
+  {
+    VectorReader reader(path, 12, VectorFormat::HEX);
+    VectorReader::WV block(12);
+
+    EXPECT_EQ(reader.read(block, 1), 3);
+    EXPECT_FALSE(reader.isMalformed());
+
+    std::vector<std::uint64_t> values(3, 0);
+    for (std::size_t bit = 0; bit < 12; bit++) {
+      for (std::size_t lane = 0; lane < 3; lane++) {
+        values[lane] |= ((block[bit] >> lane) & 1) << bit;
+      }
+    }
+    EXPECT_EQ(values, (std::vector<std::uint64_t>{0x0a5, 0xff, 0x123}));
+  }
+
+  // The malformed vectors are rejected (the reading stops there).
+  for (const auto *line : {"0x\n", "12g4\n", "0x12 34\n", "x12\n"}) {
+    {
+      std::ofstream vectors(path);
+      vectors << "1\n" << line << "2\n";
+    }
+
+    VectorReader reader(path, 12, VectorFormat::HEX);
+    VectorReader::WV block(12);
+
+    EXPECT_EQ(reader.read(block, 1), 1);
+    EXPECT_TRUE(reader.isMalformed());
+  }
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST(StreamTest, StreamBinaryTest) {
+  Simulator simulator;
+  GNet net;
+  GNet::LinkList in, out;
+  makeNet(net, in, out);
+
+  auto reference = simulator.compile(net, in, out);
+  auto compiled = simulator.compile(net, in, out, 8);
+
+  const auto dir = std::filesystem::temp_directory_path()
+                 / ("utopia-stream-test-" + std::to_string(getpid()));
+  std::filesystem::create_directories(dir);
+
+  const auto stimulusPath = (dir / "stimulus.bin").string();
+  const auto responsePath = (dir / "response.bin").string();
+
+  const std::size_t nVectors = 4099;
+
+  std::mt19937 gen(1);
+  std::string expected;
+  {
+    std::ofstream stimulus(stimulusPath, std::ios::binary);
+    for (std::size_t i = 0; i < nVectors; i++) {
+      const std::uint64_t vector = gen() & 0xfff;
+      stimulus.put(static_cast<char>(vector & 0xff));
+      stimulus.put(static_cast<char>(vector >> 8));
+
+      std::uint64_t response;
+      reference.simulate(response, vector);
+      expected.push_back(static_cast<char>(response));
+    }
+  }
+
+  {
+    VectorReader stimulus(stimulusPath, in.size(), VectorFormat::BINARY);
+    VectorWriter response(responsePath, out.size(), VectorFormat::BINARY);
+
+    const auto stats = simulate(compiled, stimulus, &response);
+    EXPECT_EQ(stats.nVectors, nVectors);
+  }
+
+  std::ifstream response(responsePath, std::ios::binary);
+  const std::string results((std::istreambuf_iterator<char>(response)),
+                            std::istreambuf_iterator<char>());
+  EXPECT_EQ(results, expected);
+
+  std::filesystem::remove_all(dir);
+}
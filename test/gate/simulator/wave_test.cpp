@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/simulator/wave.h"
+#include "util/bench.h"
+
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace eda::gate::model;
+using namespace eda::gate::simulator;
+
+TEST(WaveTest, WaveDumpTest) {
+  using Compiled = Simulator::Compiled;
+  using Clock = std::chrono::high_resolution_clock;
+
+  // Counters w/ enable.
+  const std::size_t nBlocks = 64;
+  const std::size_t nBits = 8;
+
+  GNet net;
+  GNet::LinkList in, out;
+  std::vector<WaveWriter::Signal> signals;
+
+  const auto clk = net.addIn();
+  in.push_back(Gate::Link(clk));
+  signals.emplace_back("clk", Gate::Link(clk));
+
+  for (std::size_t i = 0; i < nBlocks; i++) {
+    const auto ena = net.addIn();
+    in.push_back(Gate::Link(ena));
+
+    std::vector<Gate::Id> q;
+    for (std::size_t j = 0; j < nBits; j++) {
+      q.push_back(net.newGate());
+    }
+    auto carry = ena;
+    for (std::size_t j = 0; j < nBits; j++) {
+      net.setDff(q[j], net.addXor(q[j], carry), clk);
+      carry = net.addAnd(carry, q[j]);
+      out.push_back(Gate::Link(net.addOut(q[j])));
+      signals.emplace_back("q" + std::to_string(i) + "_" + std::to_string(j),
+                           Gate::Link(q[j]));
+    }
+  }
+  net.sortTopologically();
+
+  const std::size_t nCycles = 4096;
+
+  std::mt19937_64 gen(0);
+  Compiled::WV stimulus(nCycles * in.size());
+  for (std::size_t cycle = 0; cycle < nCycles; cycle++) {
+    stimulus[cycle * in.size()] = (cycle & 1) ? ~Compiled::W{0} : 0;
+    for (std::size_t i = 1; i < in.size(); i++) {
+      stimulus[cycle * in.size() + i] = gen() & gen();
+    }
+  }
+
+  const auto dir = std::filesystem::temp_directory_path()
+                 / ("utopia-wave-test-" + std::to_string(getpid()));
+  std::filesystem::create_directories(dir);
+
+  const auto wavePath = (dir / "dump.wave").string();
+  const auto vcdPath = (dir / "dump.vcd").string();
+
+  auto simulate = [&](bool isTraced, Compiled::WV &responses) {
+    auto compiled = Simulator().compile(net, in, out);
+    auto wave = isTraced
+        ? std::make_unique<WaveWriter>(wavePath, compiled, signals)
+        : nullptr;
+
+    const auto start = Clock::now();
+    compiled.run(nCycles,
+        [&](std::size_t cycle, Compiled::W *values) {
+          std::copy_n(stimulus.data() + cycle * in.size(), in.size(), values);
+        },
+        [&](std::size_t cycle, const Compiled::W *values) {
+          std::copy_n(values, out.size(),
+                      responses.data() + cycle * out.size());
+          if (wave) wave->sample();
+        });
+    wave.reset();
+
+    return Clock::now() - start;
+  };
+
+  // The simulation w/ and w/o tracing.
+  Compiled::WV expected(nCycles * out.size()), results(expected.size());
+  const auto plainTime = simulate(false, expected);
+  const auto traceTime = simulate(true, results);
+  EXPECT_EQ(results, expected);
+
+  // The values are restored from the waveform.
+  WaveReader reader(wavePath);
+  EXPECT_TRUE(reader.isOpen());
+  EXPECT_EQ(reader.names().size(), signals.size());
+
+  std::size_t nRead = 0;
+  for (const auto *values = reader.next(); values; values = reader.next()) {
+    for (std::size_t i = 0; i < out.size(); i++) {
+      EXPECT_EQ((*values)[i + 1], expected[nRead * out.size() + i]);
+    }
+    nRead++;
+  }
+  EXPECT_EQ(nRead, nCycles);
+
+  // The waveform is exported to VCD.
+  EXPECT_TRUE(exportVcd(wavePath, vcdPath, 5));
+
+  std::ifstream vcdFile(vcdPath);
+  std::stringstream vcd;
+  vcd << vcdFile.rdbuf();
+
+  EXPECT_NE(vcd.str().find("$var wire 1 ! clk $end"), std::string::npos);
+  EXPECT_NE(vcd.str().find("#1\n1!\n"), std::string::npos);
+  EXPECT_NE(vcd.str().find("#2\n0!\n"), std::string::npos);
+
+  using std::chrono::milliseconds;
+  benchOut() << "BENCH wave: " << nCycles << " cycles, " << signals.size()
+            << " signals: "
+            << std::chrono::duration_cast<milliseconds>(plainTime).count()
+            << "ms, traced "
+            << std::chrono::duration_cast<milliseconds>(traceTime).count()
+            << "ms; " << std::filesystem::file_size(wavePath)
+            << " bytes vs. " << nCycles * signals.size() * 8 << " raw"
+            << std::endl;
+
+  std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "rtl/model/net.h"
+
+#include "gtest/gtest.h"
+
+using namespace eda::rtl::model;
+
+// Checks that each fanout entry points to the input reading the node.
+static void checkLinks(const Net &net) {
+  for (const auto *vnode : net.vnodes()) {
+    for (const auto link : vnode->links()) {
+      EXPECT_EQ(link.source, vnode->id());
+      EXPECT_EQ(VNode::get(link.target)->input(link.input).node(), vnode->id());
+    }
+  }
+}
+
+TEST(RtlNetTest, RtlNetUpdateTest) {
+  const Type type(Type::UINT, 1);
+
+  Net net;
+  const auto x = net.addSrc(Variable("x", Variable::WIRE, type));
+  const auto y = net.addSrc(Variable("y", Variable::WIRE, type));
+  const auto p = net.addPhi(Variable("p", Variable::WIRE, type));
+  const auto f = net.addFun(Variable("f", Variable::WIRE, type), FuncSymbol::AND,
+                            { VNode::get(p)->always(), VNode::get(x)->always() });
+
+  // The drivers' fanouts are rebuilt; the node's fanout is kept.
+  net.update(p, { VNode::get(x)->always(), VNode::get(y)->always() });
+  EXPECT_EQ(VNode::get(x)->fanout(), 2u);
+  EXPECT_EQ(VNode::get(y)->fanout(), 1u);
+  EXPECT_EQ(VNode::get(p)->fanout(), 1u);
+  EXPECT_EQ(VNode::get(p)->link(0).target, f);
+
+  net.update(p, { VNode::get(y)->always() });
+  EXPECT_EQ(VNode::get(x)->fanout(), 1u);
+  EXPECT_EQ(VNode::get(y)->fanout(), 1u);
+  EXPECT_EQ(VNode::get(p)->fanout(), 1u);
+
+  // A self-loop is appended to the kept fanout.
+  net.update(p, { VNode::get(p)->always(), VNode::get(x)->always() });
+  EXPECT_EQ(VNode::get(x)->fanout(), 2u);
+  EXPECT_EQ(VNode::get(y)->fanout(), 0u);
+  EXPECT_EQ(VNode::get(p)->fanout(), 2u);
+
+  // The links are consistent w/ the back-references (otherwise, it fails).
+  net.update(p, { VNode::get(y)->always() });
+  EXPECT_EQ(VNode::get(p)->fanout(), 1u);
+
+  checkLinks(net);
+}
@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "util/arena.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+
+using namespace eda::utils;
+
+TEST(ArenaTest, ArenaAllocTest) {
+  Arena arena(1024);
+
+  char *first = static_cast<char*>(arena.allocate(24, 8));
+  char *second = static_cast<char*>(arena.allocate(24, 8));
+
+  // Small chunks are placed contiguously within a block.
+  EXPECT_EQ(second, first + 24);
+
+  for (std::size_t i = 2; i < 1000; i++) {
+    auto *ptr = arena.allocate(24, 8);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % 8, 0u);
+  }
+
+  // Large chunks do not break the current block.
+  auto *large = static_cast<char*>(arena.allocate(4096));
+  auto *small = static_cast<char*>(arena.allocate(24, 8));
+  EXPECT_TRUE(small + 24 <= large || small >= large + 4096);
+
+  EXPECT_EQ(arena.used(), 1001 * 24 + 4096);
+  EXPECT_GE(arena.reserved(), arena.used());
+
+  arena.release();
+  EXPECT_EQ(arena.used(), 0u);
+  EXPECT_EQ(arena.nBlocks(), 0u);
+}
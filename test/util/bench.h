@@ -0,0 +1,20 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+/// Returns the stream for the benchmark reports: std::cout if $UTOPIA_BENCH
+/// is set, or a stream discarding the output otherwise.
+inline std::ostream &benchOut() {
+  static std::ostream null(nullptr);
+  static const bool isEnabled = std::getenv("UTOPIA_BENCH") != nullptr;
+  return isEnabled ? std::cout : null;
+}
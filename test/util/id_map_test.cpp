@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "util/id_map.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <map>
+#include <random>
+
+using namespace eda::utils;
+
+using Map = IdMap<uint32_t, uint32_t>;
+
+static bool checkMap(const Map &map, const std::map<uint32_t, uint32_t> &ref) {
+  if (map.size() != ref.size()) {
+    return false;
+  }
+
+  bool equal = true;
+  map.forEach([&](uint32_t id, uint32_t value) {
+    const auto i = ref.find(id);
+    equal &= (i != ref.end() && i->second == value);
+  });
+
+  for (const auto &[id, value] : ref) {
+    const auto *i = map.find(id);
+    equal &= (i != nullptr && *i == value);
+  }
+
+  return equal;
+}
+
+TEST(IdMapTest, IdMapDenseTest) {
+  Map map;
+  std::map<uint32_t, uint32_t> ref;
+
+  // Compact identifiers (in any order) are stored densely.
+  for (uint32_t id = 1000; id < 2000; id++) {
+    const auto key = (id & 1) ? id : 3000 - id;
+    EXPECT_TRUE(map.insert(key, id));
+    ref[key] = id;
+  }
+  EXPECT_FALSE(map.insert(1500, 0));
+  EXPECT_TRUE(map.isDense());
+  EXPECT_TRUE(checkMap(map, ref));
+
+  for (uint32_t id = 1000; id < 2000; id += 3) {
+    map.erase(id);
+    ref.erase(id);
+  }
+  EXPECT_FALSE(map.contains(1000));
+  EXPECT_FALSE(map.contains(0));
+  EXPECT_FALSE(map.contains(5000));
+  EXPECT_TRUE(checkMap(map, ref));
+}
+
+TEST(IdMapTest, IdMapDescendingTest) {
+  Map map;
+  std::map<uint32_t, uint32_t> ref;
+
+  // Descending identifiers (down to zero) are stored densely.
+  for (uint32_t id = 100000; id > 0; id--) {
+    EXPECT_TRUE(map.insert(id - 1, id));
+    ref[id - 1] = id;
+  }
+  EXPECT_TRUE(map.isDense());
+  EXPECT_TRUE(checkMap(map, ref));
+
+  // The headroom below the entries does not count against the density.
+  map.clear();
+  ref.clear();
+  for (uint32_t id = 11000; id > 10000; id--) {
+    map.insert(id - 1, id);
+    ref[id - 1] = id;
+  }
+  const uint32_t last = 10000 + Map::DENSITY * 1001 + Map::SLACK - 1;
+  EXPECT_TRUE(map.insert(last, 0));
+  ref[last] = 0;
+  EXPECT_TRUE(map.isDense());
+  EXPECT_TRUE(checkMap(map, ref));
+}
+
+TEST(IdMapTest, IdMapSparseTest) {
+  Map map;
+  std::map<uint32_t, uint32_t> ref;
+
+  std::mt19937 gen(0);
+  for (uint32_t i = 0; i < 1000; i++) {
+    const auto id = static_cast<uint32_t>(gen());
+    map.insert(id, i);
+    ref.emplace(id, i);
+  }
+
+  // Sparse identifiers do not blow up the memory.
+  EXPECT_FALSE(map.isDense());
+  EXPECT_TRUE(checkMap(map, ref));
+
+  map.clear();
+  EXPECT_TRUE(map.isDense());
+  EXPECT_TRUE(map.empty());
+}
@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "util/small_vector.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace eda::utils;
+
+TEST(SmallVectorTest, SmallVectorGrowTest) {
+  SmallVector<int, 2> vector{1, 2};
+  EXPECT_TRUE(vector.isInline());
+
+  for (int i = 3; i <= 100; i++) {
+    vector.push_back(vector[0] * i);
+  }
+  EXPECT_FALSE(vector.isInline());
+  EXPECT_EQ(vector.size(), 100u);
+  EXPECT_EQ(vector[99], 100);
+
+  // Erase the even numbers.
+  auto i = std::remove_if(vector.begin(), vector.end(),
+                          [](int x) { return x % 2 == 0; });
+  vector.erase(i, vector.end());
+  EXPECT_EQ(vector.size(), 50u);
+
+  SmallVector<int, 2> copy(vector);
+  EXPECT_TRUE(copy == vector);
+
+  const std::vector<int> expected(copy.begin(), copy.end());
+  copy.assign(expected.begin(), expected.begin() + 2);
+  EXPECT_EQ(copy.size(), 2u);
+  EXPECT_EQ(copy.back(), 3);
+}
@@ -0,0 +1,38 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2022 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "util/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+using namespace eda::utils;
+
+TEST(ThreadPoolTest, ThreadPoolForTest) {
+  ThreadPool pool(4);
+
+  auto future = pool.submit([]() { return 42; });
+  EXPECT_EQ(future.get(), 42);
+
+  const std::size_t n = 100000;
+  std::vector<int> marks(n, 0);
+  std::atomic<std::size_t> nChunks = 0;
+
+  pool.parallelFor(n, 1000, [&](std::size_t begin, std::size_t end) {
+    for (auto i = begin; i < end; i++) {
+      marks[i]++;
+    }
+    nChunks++;
+  });
+
+  EXPECT_EQ(nChunks, n / 1000);
+  EXPECT_EQ(std::count(marks.begin(), marks.end(), 1), n);
+}